@@ -0,0 +1,31 @@
+#ifndef BINARYIO_H
+#define BINARYIO_H
+
+// Little-endian reading and writing of plain numbers, shared by the engine's
+// file formats (replays, genomes...) so files work on any machine.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+template <typename T>
+inline void writeLE(std::ostream& out, T value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) out.put(char((bits >> (8 * i)) & 0xFF));
+}
+
+template <typename T>
+inline bool readLE(std::istream& in, T& value) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        const int c = in.get();
+        if (c == EOF) return false;
+        bits |= uint64_t(uint8_t(c)) << (8 * i);
+    }
+    std::memcpy(&value, &bits, sizeof(T));
+    return true;
+}
+
+#endif // BINARYIO_H
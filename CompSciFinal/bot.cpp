@@ -0,0 +1,68 @@
+#include "bot.h"
+
+#include <cmath>
+
+//-----------------------------------------
+SearchBot::SearchBot(uint64_t runSeed, const Rect& bounds, uint64_t botSeed, LevelGenerator generator)
+    : sim(runSeed, bounds, generator), rng(botSeed) {
+    plan.reserve(PlanTicks);
+    candidate.reserve(PlanTicks);
+}
+
+uint8_t SearchBot::nextInput(const SimState& state) {
+    if (plan.empty() || planPos >= ReplanEvery) replan(state);
+    return plan[planPos++];
+}
+
+//-----------------------------------------
+// Random plans are made of short stretches of holding the same keys,
+// which is how a person plays and reaches much further than random taps.
+void SearchBot::randomFill(std::vector<uint8_t>& inputs, size_t from) {
+    static const uint8_t choices[6] = {InputLeft, InputRight, InputLeft | InputJump,
+                                       InputRight | InputJump, InputJump, 0};
+    inputs.resize(PlanTicks);
+    size_t i = from;
+    while (i < inputs.size()) {
+        const uint8_t input = choices[rng.bounded(0, 6)];
+        const int hold = rng.bounded(3, 20);
+        for (int k = 0; k < hold && i < inputs.size(); ++k) inputs[i++] = input;
+    }
+}
+
+//-----------------------------------------
+// Higher is better. Reaching the goal beats everything (sooner is better),
+// touching a spike is worst, otherwise closer to the goal is better.
+double SearchBot::score(const SimState& start, const std::vector<uint8_t>& inputs) {
+    sim.restore(start);
+    for (size_t t = 0; t < inputs.size(); ++t) {
+        const uint8_t events = sim.step(inputs[t]);
+        if (events & StepWon) return 1e9 - double(t);
+        if (events & (StepDied | StepGameOver)) return -1e9 + double(t);
+    }
+
+    const SimState& end = sim.state();
+    const Rect& goal = sim.level().goal;
+    const double dx = goal.x + goal.w / 2 - (end.x + LevelConfig::PlayerSize / 2);
+    const double dy = goal.y + goal.h / 2 - (end.y + LevelConfig::PlayerSize / 2);
+    return -std::hypot(dx, dy * 2);   // Height is the hard part, so it counts double
+}
+
+void SearchBot::replan(const SimState& state) {
+    // Start from what's left of the current plan, so the bot keeps a good idea going
+    std::vector<uint8_t> best;
+    if (!plan.empty() && planPos < int(plan.size())) best.assign(plan.begin() + planPos, plan.end());
+    randomFill(best, best.size());
+    double bestScore = score(state, best);
+
+    for (int c = 0; c < Candidates; ++c) {
+        randomFill(candidate, 0);
+        const double s = score(state, candidate);
+        if (s > bestScore) {
+            bestScore = s;
+            best.swap(candidate);
+        }
+    }
+
+    plan.swap(best);
+    planPos = 0;
+}
@@ -0,0 +1,40 @@
+#ifndef BOT_H
+#define BOT_H
+
+// Computer players. They look at the game state and pick the input for the
+// next tick, so they can drive either the headless Simulation or GameView.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "simulation.h"
+
+//-----------------------------------------
+// A bot that plans ahead by trying random input sequences in its own copy of
+// the simulation and following the one that gets closest to the goal
+// (or reaches it) without touching a spike. It plans again every few ticks.
+class SearchBot {
+public:
+    SearchBot(uint64_t runSeed, const Rect& bounds, uint64_t botSeed = 1,
+              LevelGenerator generator = LevelGenerator::Classic);
+
+    // The input to use for this tick, given where the game is right now
+    uint8_t nextInput(const SimState& state);
+
+private:
+    static constexpr int Candidates = 48;      // Random plans tried each time
+    static constexpr int PlanTicks = 90;       // How far ahead each plan looks
+    static constexpr int ReplanEvery = 8;      // Ticks followed before planning again
+
+    Simulation sim;
+    Rng rng;
+    std::vector<uint8_t> plan;
+    std::vector<uint8_t> candidate;
+    int planPos = 0;
+
+    void replan(const SimState& state);
+    void randomFill(std::vector<uint8_t>& inputs, size_t from);
+    double score(const SimState& start, const std::vector<uint8_t>& inputs);
+};
+
+#endif // BOT_H
@@ -0,0 +1,234 @@
+#include "chunkgenerator.h"
+
+#include <algorithm>
+
+using namespace LevelConfig;
+using namespace ChunkConfig;
+
+//-----------------------------------------
+// How a chunk joins its neighbours.
+//
+// The side edges of a chunk are at one of three heights. Walking or jumping from
+// one chunk into the next works when the two edges are at most one height apart.
+//
+// "Central" is a platform at the lowest height covering at least x 80..120 with
+// no spike. The player can jump straight up from it onto the central platform of
+// the chunk above (125px), and the goal is placed right above it.
+// The edge heights are platform tops at y 120, 80 and 40 in the cell.
+enum EdgeHeight : int8_t { NoEdge = -1, EdgeLow = 0, EdgeMid = 1, EdgeHigh = 2 };
+
+// Ways into and out of a chunk
+enum Port : uint8_t { PortLeft = 0, PortRight = 1, PortCentral = 2 };
+static constexpr int PortCount = 3;
+static constexpr uint8_t bit(Port p) { return uint8_t(1 << p); }
+
+//-----------------------------------------
+// One chunk, in cell coordinates (0,0 is the top-left corner of the cell).
+// Platforms are PlatformHeight tall; a spike sits on a platform top with its left corner at x.
+struct ChunkPlatform {
+    double x, y, w;
+};
+struct ChunkSpike {
+    double x, y;
+};
+
+struct Chunk {
+    int8_t left;                  // EdgeHeight of the left and right edges
+    int8_t right;
+    bool central;
+    uint8_t reach[PortCount];     // Ports that can be reached after coming in through each port
+    int platformCount;
+    ChunkPlatform platforms[4];
+    int spikeCount;
+    ChunkSpike spikes[2];
+};
+
+static constexpr uint8_t All = bit(PortLeft) | bit(PortRight) | bit(PortCentral);
+static constexpr uint8_t LeftRight = bit(PortLeft) | bit(PortRight);
+
+// Chunks the path goes through. Every port listed in "reach" must really be
+// reachable in the game; route_search --generator chunks is the check for that.
+static constexpr Chunk PathChunks[] = {
+    // Flat floor
+    {EdgeLow, EdgeLow, true, {All, All, All}, 1, {{0, 120, 200}}, 0, {}},
+    // Floor with a spike to jump
+    {EdgeLow, EdgeLow, true, {All, All, All}, 1, {{0, 120, 200}}, 1, {{150, 120}}},
+    // Two spikes
+    {EdgeLow, EdgeLow, true, {All, All, All}, 1, {{0, 120, 200}}, 2, {{30, 120}, {150, 120}}},
+    // Step up to the right
+    {EdgeLow, EdgeMid, true, {All, All, All}, 2, {{0, 120, 125}, {125, 80, 75}}, 0, {}},
+    // Step up to the left
+    {EdgeMid, EdgeLow, true, {All, All, All}, 2, {{0, 80, 75}, {75, 120, 125}}, 0, {}},
+    // A dip between two ledges
+    {EdgeMid, EdgeMid, true, {All, All, All}, 3, {{0, 80, 60}, {60, 120, 80}, {140, 80, 60}}, 0, {}},
+    // Stairs down from the left
+    {EdgeHigh, EdgeMid, true, {All, All, All}, 4, {{0, 40, 40}, {40, 80, 40}, {80, 120, 60}, {140, 80, 60}}, 0, {}},
+    // Stairs down from the right
+    {EdgeMid, EdgeHigh, true, {All, All, All}, 4, {{0, 80, 60}, {60, 120, 60}, {120, 80, 40}, {160, 40, 40}}, 0, {}},
+    // Spike in the middle: only left to right
+    {EdgeLow, EdgeLow, false, {LeftRight, LeftRight, 0}, 1, {{0, 120, 200}}, 1, {{90, 120}}},
+    // High walkway
+    {EdgeHigh, EdgeHigh, false, {LeftRight, LeftRight, 0}, 1, {{0, 40, 200}}, 0, {}},
+    // A pit to jump over
+    {EdgeLow, EdgeLow, false, {LeftRight, LeftRight, 0}, 2, {{0, 120, 70}, {130, 120, 70}}, 0, {}},
+    // Dead end on the right, with a spike at the end
+    {EdgeLow, NoEdge, true, {bit(PortLeft) | bit(PortCentral), 0, bit(PortLeft) | bit(PortCentral)},
+     1, {{0, 120, 160}}, 1, {{140, 120}}},
+    // Dead end on the left
+    {NoEdge, EdgeLow, true, {0, bit(PortRight) | bit(PortCentral), bit(PortRight) | bit(PortCentral)},
+     1, {{40, 120, 160}}, 1, {{40, 120}}},
+};
+static constexpr int PathChunkCount = int(sizeof(PathChunks) / sizeof(PathChunks[0]));
+
+// Chunks for cells the path does not use. Everything sits near the top of the
+// cell, so the floor of the chunk above is still far enough over its spikes.
+// The first SafeFillerCount have no spikes: they go right above path cells,
+// where a jump from a high ledge below can reach the whole cell.
+static constexpr Chunk FillerChunks[] = {
+    {NoEdge, NoEdge, false, {0, 0, 0}, 0, {}, 0, {}},
+    {NoEdge, NoEdge, false, {0, 0, 0}, 1, {{40, 30, 80}}, 0, {}},
+    {NoEdge, NoEdge, false, {0, 0, 0}, 2, {{0, 30, 60}, {140, 30, 60}}, 0, {}},
+    {NoEdge, NoEdge, false, {0, 0, 0}, 1, {{60, 30, 80}}, 1, {{90, 30}}},
+    {NoEdge, NoEdge, false, {0, 0, 0}, 2, {{20, 30, 60}, {120, 30, 60}}, 1, {{40, 30}}},
+};
+static constexpr int FillerChunkCount = int(sizeof(FillerChunks) / sizeof(FillerChunks[0]));
+static constexpr int SafeFillerCount = 3;
+
+//-----------------------------------------
+// The tables. For every way into a cell (which port, and how high the
+// neighbour's edge was) and every way out, the list of chunks that fit.
+// They are built by the compiler, so generating a level never checks a chunk.
+struct ChunkChoices {
+    int count;
+    uint8_t ids[PathChunkCount];
+};
+
+struct ChunkTables {
+    // [entry port][height of the edge we came in over][exit port]
+    ChunkChoices choices[PortCount][3][PortCount];
+};
+
+static constexpr bool edgesJoin(int a, int b) {
+    return a != NoEdge && b != NoEdge && (a - b <= 1) && (b - a <= 1);
+}
+
+static constexpr bool chunkFits(const Chunk& chunk, Port entry, int edge, Port exit) {
+    // Coming in: over a side edge next to one the chunk has, or up onto its central platform
+    if (entry == PortLeft && !edgesJoin(chunk.left, edge)) return false;
+    if (entry == PortRight && !edgesJoin(chunk.right, edge)) return false;
+    if (entry == PortCentral && !chunk.central) return false;
+
+    // Going out through a port the chunk has, and can get to from the entry
+    if (exit == PortLeft && chunk.left == NoEdge) return false;
+    if (exit == PortRight && chunk.right == NoEdge) return false;
+    if (exit == PortCentral && !chunk.central) return false;
+    return (chunk.reach[entry] & bit(exit)) != 0;
+}
+
+static constexpr ChunkTables buildTables() {
+    ChunkTables tables{};
+    for (int entry = 0; entry < PortCount; ++entry)
+        for (int edge = 0; edge < 3; ++edge)
+            for (int exit = 0; exit < PortCount; ++exit) {
+                ChunkChoices& list = tables.choices[entry][edge][exit];
+                for (int id = 0; id < PathChunkCount; ++id)
+                    if (chunkFits(PathChunks[id], Port(entry), edge, Port(exit))) list.ids[list.count++] = uint8_t(id);
+            }
+    return tables;
+}
+
+static constexpr ChunkTables Tables = buildTables();
+
+// Every move the walk can make must have at least one chunk. Checked when compiling.
+static constexpr bool tablesComplete() {
+    for (int entry = 0; entry < PortCount; ++entry)
+        for (int edge = 0; edge < 3; ++edge)
+            for (int exit = 0; exit < PortCount; ++exit) {
+                if (entry == exit && entry != PortCentral) continue;   // The walk never turns back
+                if (entry == PortCentral && edge != EdgeLow) continue; // Coming up has no edge height
+                if (Tables.choices[entry][edge][exit].count == 0) return false;
+            }
+    return true;
+}
+static_assert(tablesComplete(), "Some way through a cell has no chunk; add one to PathChunks");
+
+//-----------------------------------------
+// Copy a chunk into the level at the cell whose top-left corner is (x, y)
+static void placeChunk(LevelData& level, const Chunk& chunk, double x, double y) {
+    for (int i = 0; i < chunk.platformCount; ++i) {
+        const ChunkPlatform& p = chunk.platforms[i];
+        level.platforms.push_back(Rect{x + p.x, y + p.y, p.w, PlatformHeight});
+    }
+    for (int i = 0; i < chunk.spikeCount; ++i) {
+        const ChunkSpike& s = chunk.spikes[i];
+        level.spikes.push_back(Triangle{Vec2{x + s.x + SpikeWidth / 2, y + s.y - SpikeHeight},
+                                        Vec2{x + s.x, y + s.y},
+                                        Vec2{x + s.x + SpikeWidth, y + s.y}});
+    }
+}
+
+static int pickChunk(Rng& rng, Port entry, int edge, Port exit) {
+    const ChunkChoices& list = Tables.choices[entry][entry == PortCentral ? int(EdgeLow) : edge][exit];
+    return list.ids[rng.bounded(0, list.count)];
+}
+
+//-----------------------------------------
+LevelData generateChunkLevel(uint64_t runSeed, int levelIndex, const Rect& bounds) {
+    LevelData level;
+    level.bounds = bounds;
+    level.spawn = Vec2{bounds.w / 2, bounds.h - PlayerSize};
+
+    Rng rng(levelSeed(runSeed, levelIndex) ^ 0x4348554E4B53ull);
+
+    // The grid is centred sideways and sits on the floor. The bottom row is left
+    // empty so the floor is free to walk on.
+    const int cols = std::max(1, int(bounds.w / CellWidth));
+    const int rows = std::max(3, int(bounds.h / CellHeight));
+    const double originX = bounds.x + (bounds.w - cols * CellWidth) / 2;
+    const double originY = bounds.bottom() - rows * CellHeight;
+    std::vector<int> cells(size_t(cols * rows), -1);   // Path chunk id, or -1
+
+    // The goal goes in the top half, like the other generators
+    const int goalRow = rng.bounded(0, std::max(1, rows / 2));
+    const int goalCol = rng.bounded(0, cols);
+
+    // The walk: start above some spot on the floor, cross each row sideways to
+    // a random column, go up, and so on until the goal cell
+    int col = rng.bounded(0, cols);
+    Port entry = PortCentral;
+    int edge = EdgeLow;
+    for (int row = rows - 2; row >= goalRow; --row) {
+        const int target = row == goalRow ? goalCol : rng.bounded(0, cols);
+        for (;;) {
+            const Port exit = col == target ? PortCentral : (target > col ? PortRight : PortLeft);
+            const int id = pickChunk(rng, entry, edge, exit);
+            cells[size_t(row * cols + col)] = id;
+            if (exit == PortCentral) break;
+
+            // Into the next cell over its edge
+            edge = exit == PortRight ? PathChunks[id].right : PathChunks[id].left;
+            entry = exit == PortRight ? PortLeft : PortRight;
+            col += exit == PortRight ? 1 : -1;
+        }
+        entry = PortCentral;
+        edge = EdgeLow;
+    }
+
+    // Build the cells: the path chunks, and fillers everywhere else above the floor row
+    level.platforms.reserve(size_t(cols * rows) * 2);
+    for (int row = 0; row < rows - 1; ++row) {
+        for (int c = 0; c < cols; ++c) {
+            const double x = originX + c * CellWidth;
+            const double y = originY + row * CellHeight;
+            const int id = cells[size_t(row * cols + c)];
+            const bool overPath = row + 1 < rows && cells[size_t((row + 1) * cols + c)] >= 0;
+            if (id >= 0) placeChunk(level, PathChunks[id], x, y);
+            else placeChunk(level, FillerChunks[rng.bounded(0, overPath ? SafeFillerCount : FillerChunkCount)], x, y);
+        }
+    }
+
+    // The goal sits right above the goal cell's central platform
+    level.goal = Rect{originX + goalCol * CellWidth + CellWidth / 2 - GoalSize / 2, originY + goalRow * CellHeight + 20,
+                      GoalSize, GoalSize};
+    return level;
+}
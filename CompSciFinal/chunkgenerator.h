@@ -0,0 +1,21 @@
+#ifndef CHUNKGENERATOR_H
+#define CHUNKGENERATOR_H
+
+// The chunk generator. The level is a grid of cells, and every cell is filled
+// with a hand-made chunk (a few platforms and spikes). A path of cells is walked
+// from the floor to the goal, and each cell on it takes a chunk that fits its
+// neighbours and gets the player through it. Which chunks fit where is worked out
+// by the compiler from the chunk list (see chunkgenerator.cpp), so making a level
+// is only a walk and some table lookups, however big the level is.
+#include "level.h"
+
+namespace ChunkConfig {
+    constexpr double CellWidth = 200;
+    constexpr double CellHeight = 125;
+}
+
+// Level "levelIndex" (1 or more) of the run "runSeed". Wider or taller bounds
+// just mean more cells.
+LevelData generateChunkLevel(uint64_t runSeed, int levelIndex, const Rect& bounds);
+
+#endif // CHUNKGENERATOR_H
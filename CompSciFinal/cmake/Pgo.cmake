@@ -0,0 +1,38 @@
+# Profile-guided optimization (PGO) flags for every target in the project.
+#
+# CSF_PGO=GENERATE builds instrumented programs that write profile data into
+# CSF_PGO_DIR when they run. After running the training workload, configure the
+# SAME build folder again with CSF_PGO=USE and rebuild: the compiler then uses
+# the profile to lay out and inline the hot code. cmake/PgoBuild.cmake runs the
+# whole sequence, including training and the comparison against a plain build.
+set(CSF_PGO "OFF" CACHE STRING "Profile-guided optimization stage: OFF, GENERATE or USE")
+set_property(CACHE CSF_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(CSF_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-data" CACHE PATH "Folder for PGO profile data")
+
+if(NOT CSF_PGO STREQUAL "OFF")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        if(CSF_PGO STREQUAL "GENERATE")
+            # Atomic counters, because several tools run the engine on many threads
+            set(CSF_PGO_FLAGS -fprofile-generate=${CSF_PGO_DIR} -fprofile-update=atomic)
+        elseif(CSF_PGO STREQUAL "USE")
+            set(CSF_PGO_FLAGS -fprofile-use=${CSF_PGO_DIR} -fprofile-correction -Wno-missing-profile)
+        endif()
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        if(CSF_PGO STREQUAL "GENERATE")
+            set(CSF_PGO_FLAGS -fprofile-generate=${CSF_PGO_DIR})
+        elseif(CSF_PGO STREQUAL "USE")
+            # Clang needs the raw profiles merged first (llvm-profdata merge, done by PgoBuild.cmake)
+            set(CSF_PGO_FLAGS -fprofile-use=${CSF_PGO_DIR}/merged.profdata
+                              -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date)
+        endif()
+    else()
+        message(FATAL_ERROR "CSF_PGO needs GCC or Clang (found ${CMAKE_CXX_COMPILER_ID})")
+    endif()
+
+    if(NOT CSF_PGO_FLAGS)
+        message(FATAL_ERROR "CSF_PGO must be OFF, GENERATE or USE (got ${CSF_PGO})")
+    endif()
+    message(STATUS "PGO ${CSF_PGO}: ${CSF_PGO_DIR}")
+    add_compile_options(${CSF_PGO_FLAGS})
+    add_link_options(${CSF_PGO_FLAGS})
+endif()
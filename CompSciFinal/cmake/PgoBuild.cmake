@@ -0,0 +1,176 @@
+# Builds the project with profile-guided optimization and reports the speedup.
+#
+#   cmake -P cmake/PgoBuild.cmake
+#   cmake -DCORPUS=path/to/replays -DHEADLESS=ON -P cmake/PgoBuild.cmake
+#
+# Options (all optional):
+#   CORPUS      folder of recorded *.replay runs used for training and benchmarking
+#   SEEDS       number of generated seeds to train/benchmark on (default 300)
+#   HEADLESS    ON builds only the engine and headless tools (no Qt needed)
+#   BUILD_ROOT  where the two build folders go (default <source>/_pgo)
+#   GENERATOR   CMake generator to use (default: CMake's own default)
+#   LEVEL_GENERATORS  level generators the seeds are trained on
+#               (default "classic;path;chunks;hills"; the comparison uses classic)
+#
+# Steps: a plain Release build, an instrumented build, a training run
+# (engine_bench on the corpus and seeds of every level generator, plus a short offscreen soak test of
+# the game), a rebuild of the instrumented folder with the profile, and
+# finally engine_bench on both builds to compare them.
+cmake_minimum_required(VERSION 3.16)
+
+get_filename_component(SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+if(NOT BUILD_ROOT)
+    set(BUILD_ROOT "${SOURCE_DIR}/_pgo")
+endif()
+if(NOT SEEDS)
+    set(SEEDS 300)
+endif()
+if(NOT LEVEL_GENERATORS)
+    set(LEVEL_GENERATORS classic path chunks hills)
+endif()
+if(NOT DEFINED HEADLESS)
+    set(HEADLESS OFF)
+endif()
+
+set(RELEASE_DIR "${BUILD_ROOT}/release")
+set(PGO_DIR "${BUILD_ROOT}/pgo")
+set(PROFILE_DIR "${PGO_DIR}/pgo-data")
+
+set(CORPUS_ARGS)
+if(CORPUS)
+    get_filename_component(CORPUS "${CORPUS}" ABSOLUTE)
+    set(CORPUS_ARGS "${CORPUS}")
+endif()
+
+#-----------------------------------------
+# Small helpers
+function(run_step description)
+    message(STATUS "==> ${description}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${description} failed (${result})")
+    endif()
+endfunction()
+
+function(configure_build dir stage)
+    set(args -S "${SOURCE_DIR}" -B "${dir}" -DCMAKE_BUILD_TYPE=Release -DCSF_PGO=${stage}
+             -DCSF_PGO_DIR=${PROFILE_DIR} -DCSF_HEADLESS_ONLY=${HEADLESS})
+    if(GENERATOR)
+        list(APPEND args -G "${GENERATOR}")
+    endif()
+    run_step("Configure ${dir} (PGO ${stage})" "${CMAKE_COMMAND}" ${args})
+endfunction()
+
+# Find a built program (multi-config generators put it in a Release subfolder)
+function(find_built_program out dir name)
+    set(suffix "")
+    if(CMAKE_HOST_WIN32)
+        set(suffix ".exe")
+    endif()
+    foreach(candidate "${dir}/${name}${suffix}" "${dir}/Release/${name}${suffix}")
+        if(EXISTS "${candidate}")
+            set(${out} "${candidate}" PARENT_SCOPE)
+            return()
+        endif()
+    endforeach()
+    message(FATAL_ERROR "Could not find ${name} in ${dir}")
+endfunction()
+
+# Run engine_bench and pull the numbers out of its RESULT line
+function(run_bench dir prefix)
+    find_built_program(bench "${dir}" engine_bench)
+    execute_process(COMMAND "${bench}" ${CORPUS_ARGS} --seeds ${SEEDS} --repeat 5
+                    OUTPUT_VARIABLE output RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "engine_bench failed in ${dir}")
+    endif()
+    message("${output}")
+    foreach(key generate_ns replay_step_ns seed_step_ns checksum)
+        string(REGEX MATCH "${key}=([0-9a-fA-F.]+)" _ "${output}")
+        set(${prefix}_${key} "${CMAKE_MATCH_1}" PARENT_SCOPE)
+    endforeach()
+endfunction()
+
+#-----------------------------------------
+# 1. Plain release build
+configure_build("${RELEASE_DIR}" OFF)
+run_step("Build release" "${CMAKE_COMMAND}" --build "${RELEASE_DIR}" --config Release --parallel)
+
+# 2. Instrumented build, starting from an empty profile folder
+file(REMOVE_RECURSE "${PROFILE_DIR}")
+configure_build("${PGO_DIR}" GENERATE)
+run_step("Build instrumented" "${CMAKE_COMMAND}" --build "${PGO_DIR}" --config Release --parallel --clean-first)
+
+# 3. Training: the headless engine on the corpus and generated seeds
+find_built_program(trainBench "${PGO_DIR}" engine_bench)
+if(CORPUS)
+    run_step("Train on corpus" "${trainBench}" ${CORPUS_ARGS} --seeds 0 --repeat 1)
+endif()
+foreach(levelGenerator IN LISTS LEVEL_GENERATORS)
+    run_step("Train on ${SEEDS} ${levelGenerator} seeds" "${trainBench}" --seeds ${SEEDS} --repeat 1
+             --generator ${levelGenerator})
+endforeach()
+if(NOT HEADLESS)
+    # ...and the real game loop, driven by the soak bot without a window
+    find_built_program(game "${PGO_DIR}" CompSciFinal)
+    run_step("Train the game with a soak run" "${CMAKE_COMMAND}" -E env QT_QPA_PLATFORM=offscreen
+             "${game}" --seed 1 --soak 100)
+endif()
+
+# Clang writes raw profiles that have to be merged into one file
+file(GLOB rawProfiles "${PROFILE_DIR}/*.profraw")
+if(rawProfiles)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata)
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "Clang profiles need llvm-profdata, which was not found")
+    endif()
+    run_step("Merge profiles" "${LLVM_PROFDATA}" merge -output=${PROFILE_DIR}/merged.profdata ${rawProfiles})
+endif()
+
+# 4. Rebuild the same folder (same object paths, so the profile matches) using the profile
+configure_build("${PGO_DIR}" USE)
+run_step("Build with profile" "${CMAKE_COMMAND}" --build "${PGO_DIR}" --config Release --parallel --clean-first)
+
+# 5. Compare
+run_bench("${RELEASE_DIR}" release)
+run_bench("${PGO_DIR}" pgo)
+
+if(NOT release_checksum STREQUAL pgo_checksum)
+    message(FATAL_ERROR "The PGO build plays differently (checksum ${pgo_checksum} vs ${release_checksum})")
+endif()
+
+# CMake's math() only knows whole numbers, so work in hundredths of a nanosecond
+function(to_hundredths out value)
+    if(NOT value MATCHES "^[0-9]")
+        set(${out} 0 PARENT_SCOPE)
+        return()
+    endif()
+    string(REGEX MATCH "^([0-9]+)\\.?([0-9]?)([0-9]?)" _ "${value}")
+    set(tenths "${CMAKE_MATCH_2}")
+    set(hundredths "${CMAKE_MATCH_3}")
+    if(tenths STREQUAL "")
+        set(tenths 0)
+    endif()
+    if(hundredths STREQUAL "")
+        set(hundredths 0)
+    endif()
+    math(EXPR result "${CMAKE_MATCH_1} * 100 + ${tenths} * 10 + ${hundredths}")
+    set(${out} ${result} PARENT_SCOPE)
+endfunction()
+
+message(STATUS "PGO speedup over plain release:")
+foreach(key generate_ns replay_step_ns seed_step_ns)
+    to_hundredths(before "${release_${key}}")
+    to_hundredths(after "${pgo_${key}}")
+    if(before GREATER 0 AND after GREATER 0)
+        math(EXPR permille "${before} * 1000 / ${after}")
+        math(EXPR whole "${permille} / 1000")
+        math(EXPR fraction "${permille} % 1000")
+        string(LENGTH "${fraction}" digits)
+        while(digits LESS 3)
+            set(fraction "0${fraction}")
+            string(LENGTH "${fraction}" digits)
+        endwhile()
+        message(STATUS "  ${key}: ${release_${key}} -> ${pgo_${key}}  (${whole}.${fraction}x)")
+    endif()
+endforeach()
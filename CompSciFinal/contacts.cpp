@@ -0,0 +1,113 @@
+#include "contacts.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simulation.h"
+
+using namespace ContactConfig;
+
+//-----------------------------------------
+// The cells covered by "r", clamped to the grid (x1 and y1 are included)
+void ContactTracker::cellRange(const Rect& r, int& x0, int& x1, int& y0, int& y1) const {
+    x0 = std::clamp(int(std::floor((r.left() - bounds.x) / CellSize)), 0, cols - 1);
+    x1 = std::clamp(int(std::floor((r.right() - bounds.x) / CellSize)), 0, cols - 1);
+    y0 = std::clamp(int(std::floor((r.top() - bounds.y) / CellSize)), 0, rows - 1);
+    y1 = std::clamp(int(std::floor((r.bottom() - bounds.y) / CellSize)), 0, rows - 1);
+}
+
+//-----------------------------------------
+void ContactTracker::build(const LevelData& level) {
+    const double pen = LevelConfig::PenHalfWidth;
+    triggers.clear();
+    triggers.push_back(Trigger{ContactGoal, 0, level.goal.adjusted(pen), level.goal, Triangle{}});
+    for (size_t i = 0; i < level.spikes.size(); ++i) {
+        const Triangle& t = level.spikes[i];
+        const double minX = std::min({t.apex.x, t.left.x, t.right.x});
+        const double maxX = std::max({t.apex.x, t.left.x, t.right.x});
+        const double minY = std::min({t.apex.y, t.left.y, t.right.y});
+        const double maxY = std::max({t.apex.y, t.left.y, t.right.y});
+        triggers.push_back(Trigger{ContactSpike, uint32_t(i), Rect{minX, minY, maxX - minX, maxY - minY}.adjusted(pen),
+                                   Rect{}, t});
+    }
+    for (size_t i = 0; i < level.checkpoints.size(); ++i)
+        triggers.push_back(Trigger{ContactCheckpoint, uint32_t(i), level.checkpoints[i].adjusted(pen), Rect{}, Triangle{}});
+
+    bounds = level.bounds;
+    cols = std::max(1, int(std::ceil(bounds.w / CellSize)));
+    rows = std::max(1, int(std::ceil(bounds.h / CellSize)));
+
+    // Count the triggers in every cell, then fill the lists in one block
+    cellStart.assign(size_t(cols * rows) + 1, 0);
+    int x0, x1, y0, y1;
+    for (const Trigger& t : triggers) {
+        cellRange(t.box, x0, x1, y0, y1);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x) cellStart[size_t(y * cols + x) + 1]++;
+    }
+    for (size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+
+    cellItems.resize(cellStart.back());
+    fill.assign(cellStart.begin(), cellStart.end() - 1);
+    for (uint32_t id = 0; id < triggers.size(); ++id) {
+        cellRange(triggers[id].box, x0, x1, y0, y1);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x) cellItems[fill[size_t(y * cols + x)]++] = id;
+    }
+
+    seenAt.assign(triggers.size(), 0);
+    updateCount = 0;
+    reset();
+}
+
+//-----------------------------------------
+void ContactTracker::update(double x, double y, ContactSet& contacts, std::vector<ContactEvent>& events) {
+    events.clear();
+    if (triggers.empty()) return;
+    ++updateCount;
+
+    // Broad phase: the triggers in the cells under the player whose boxes overlap it.
+    // Narrow phase: the exact shape test, only for those.
+    const Rect player = Rect{x, y, LevelConfig::PlayerSize, LevelConfig::PlayerSize}.adjusted(LevelConfig::PenHalfWidth);
+    nowTouching.clear();
+    int x0, x1, y0, y1;
+    cellRange(player, x0, x1, y0, y1);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            const size_t cell = size_t(cy * cols + cx);
+            for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                const uint32_t id = cellItems[i];
+                if (seenAt[id] == updateCount) continue;
+                seenAt[id] = updateCount;
+
+                const Trigger& t = triggers[id];
+                if (!t.box.intersects(player)) continue;
+
+                // A checkpoint is just its box, so the box test is exact
+                if (t.kind == ContactCheckpoint) {
+                    nowTouching.push_back(id);
+                    continue;
+                }
+                ++narrowCount;
+                const bool touches = t.kind == ContactGoal ? playerTouchesGoal(x, y, t.goal)
+                                                           : playerTouchesSpike(x, y, t.spike);
+                if (touches) nowTouching.push_back(id);
+            }
+        }
+    }
+
+    // Nothing touched now or before: the usual case, and nothing to report
+    std::vector<uint32_t>& touching = contacts.touching;
+    if (nowTouching.empty() && touching.empty()) return;
+
+    // Events: in the order the game used to check things (the goal first, then
+    // spikes in level order, then checkpoints), so reacting to the first one does the same thing
+    std::sort(nowTouching.begin(), nowTouching.end());
+    for (uint32_t id : nowTouching)
+        if (!std::binary_search(touching.begin(), touching.end(), id))
+            events.push_back(ContactEvent{triggers[id].kind, ContactEnter, triggers[id].index});
+    for (uint32_t id : touching)
+        if (!std::binary_search(nowTouching.begin(), nowTouching.end(), id))
+            events.push_back(ContactEvent{triggers[id].kind, ContactExit, triggers[id].index});
+    touching.swap(nowTouching);
+}
@@ -0,0 +1,97 @@
+#ifndef CONTACTS_H
+#define CONTACTS_H
+
+// Contacts between the player and the things it can touch (the goal, the
+// spikes and checkpoints). Instead of testing every spike every tick, the level is split into
+// a grid of cells and each cell lists what is in it. Only the things in the
+// cells under the player get the exact shape test, and the caller is told
+// when a contact starts or ends, so the game reacts to events instead of
+// asking "am I touching anything?" about every item.
+#include "level.h"
+
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------
+enum ContactKind : uint8_t {
+    ContactGoal = 0,
+    ContactSpike = 1,
+    ContactCheckpoint = 2,
+};
+
+enum ContactChange : uint8_t {
+    ContactEnter = 0,    // The player started touching it this tick
+    ContactExit = 1,     // The player stopped touching it this tick
+};
+
+struct ContactEvent {
+    ContactKind kind;
+    ContactChange change;
+    uint32_t index;      // Which spike or checkpoint (index into LevelData::spikes / checkpoints); 0 for the goal
+};
+
+// Did the player start touching something of this kind?
+inline bool contactEntered(const std::vector<ContactEvent>& events, ContactKind kind) {
+    for (const ContactEvent& e : events)
+        if (e.kind == kind && e.change == ContactEnter) return true;
+    return false;
+}
+
+namespace ContactConfig {
+    constexpr double CellSize = 50;   // Grid cell size in scene pixels
+}
+
+// What one player is touching. Several players can share one ContactTracker
+// (and so one grid) by each keeping their own ContactSet.
+struct ContactSet {
+    std::vector<uint32_t> touching;   // Triggers touched at the last update, sorted
+    void clear() { touching.clear(); }
+};
+
+//-----------------------------------------
+class ContactTracker {
+public:
+    // Sort the level's goal, spikes and checkpoints into the grid. Forgets all contacts.
+    void build(const LevelData& level);
+
+    // Forget all contacts, for when the player is moved somewhere else
+    // (respawn, a new level, restoring a snapshot). Anything it touches at the
+    // next update() is a new ContactEnter.
+    void reset() { own.clear(); }
+
+    // The player is now at (x, y). "events" is filled with the contacts that
+    // started or ended since the last update.
+    void update(double x, double y, std::vector<ContactEvent>& events) { update(x, y, own, events); }
+
+    // The same for one of several players, whose contacts are kept in "contacts"
+    void update(double x, double y, ContactSet& contacts, std::vector<ContactEvent>& events);
+
+    // Exact shape tests done so far (for benchmarks)
+    uint64_t narrowTests() const { return narrowCount; }
+
+private:
+    struct Trigger {
+        ContactKind kind;
+        uint32_t index;
+        Rect box;          // Bounding box, pen included
+        Rect goal;         // The shape, for ContactGoal
+        Triangle spike;    // The shape, for ContactSpike
+    };
+
+    std::vector<Trigger> triggers;
+    std::vector<uint32_t> cellStart;   // Triggers of cell c are cellItems[cellStart[c] .. cellStart[c + 1])
+    std::vector<uint32_t> cellItems;
+    std::vector<uint32_t> seenAt;      // Last update that looked at each trigger (so none is tested twice)
+    ContactSet own;                    // The contacts of the single player update() is used for
+    std::vector<uint32_t> nowTouching;
+    std::vector<uint32_t> fill;        // Scratch space for build()
+    Rect bounds;
+    int cols = 0;
+    int rows = 0;
+    uint32_t updateCount = 0;
+    uint64_t narrowCount = 0;
+
+    void cellRange(const Rect& r, int& x0, int& x1, int& y0, int& y1) const;
+};
+
+#endif // CONTACTS_H
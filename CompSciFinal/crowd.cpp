@@ -0,0 +1,70 @@
+#include "crowd.h"
+
+using namespace CrowdConfig;
+
+//-----------------------------------------
+Crowd::Crowd(uint64_t runSeed, const Rect& bounds, LevelGenerator generator, int levelIndex, int runners)
+    : levelData(generateLevelData(runSeed, levelIndex, bounds, generator)) {
+    contacts.build(levelData);
+
+    const size_t count = size_t(runners > 0 ? runners : 0);
+    states.resize(count);
+    contactSets.resize(count);
+    brains.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        brains.push_back(Brain{Rng(runSeed ^ (0x43524F5744ull + i * 0x9E3779B97F4A7C15ull)), 0, 0});
+        respawn(i);
+    }
+}
+
+// Back to the runner's checkpoint, or to the start (the velocity follows
+// respawnPlayer(), like every other game mode)
+void Crowd::respawn(size_t runner) {
+    SimState& s = states[runner];
+    respawnPlayer(s, levelData.spawn);
+    contactSets[runner].clear();
+}
+
+//-----------------------------------------
+uint8_t Crowd::think(Brain& brain, const SimState& state) {
+    if (brain.ticksLeft > 0) {
+        --brain.ticksLeft;
+        return brain.input;
+    }
+
+    const Rect& goal = levelData.goal;
+    const bool goalIsRight = goal.x + goal.w / 2 > state.x + LevelConfig::PlayerSize / 2;
+    const uint8_t toward = goalIsRight ? InputRight : InputLeft;
+    const uint8_t away = goalIsRight ? InputLeft : InputRight;
+
+    const int roll = brain.rng.bounded(0, 100);
+    uint8_t input = roll < TowardGoalPercent ? toward : (roll < TowardGoalPercent + 20 ? away : 0);
+    if (brain.rng.bounded(0, 100) < JumpPercent) input |= InputJump;
+
+    brain.input = input;
+    brain.ticksLeft = uint8_t(brain.rng.bounded(MinHold, MaxHold));
+    return input;
+}
+
+//-----------------------------------------
+void Crowd::step() {
+    for (size_t i = 0; i < states.size(); ++i) {
+        SimState& s = states[i];
+        ++s.tick;
+        movePlayer(levelData, levelData.bounds, s, think(brains[i], s));
+
+        contacts.update(s.x, s.y, contactSets[i], events);
+        if (contactEntered(events, ContactGoal)) {
+            ++goals;
+            s.level++;
+            s.checkpoint = Checkpoint{};
+            respawn(i);
+        } else if (contactEntered(events, ContactSpike)) {
+            ++deathCount;
+            s.deaths++;
+            respawn(i);
+        } else {
+            saveCheckpoint(s, events);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef CROWD_H
+#define CROWD_H
+
+// Crowd mode: thousands of simple bot runners on one level at the same time.
+// The level, its contact grid and the rules are shared, and each runner is
+// only a SimState, its contacts and a tiny "brain", all kept in flat arrays
+// that step() runs through in one loop. Runners never run out of lives: a
+// spike puts them back at their checkpoint, and the goal back at the start.
+#include "contacts.h"
+#include "level.h"
+#include "simulation.h"
+
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------
+namespace CrowdConfig {
+    constexpr int MinHold = 4;               // Ticks a runner keeps pressing the same keys
+    constexpr int MaxHold = 24;
+    constexpr int TowardGoalPercent = 70;    // Chance of walking towards the goal (else away, or stand)
+    constexpr int JumpPercent = 45;          // Chance of holding jump as well
+}
+
+//-----------------------------------------
+class Crowd {
+public:
+    // "runners" runners on level "levelIndex" of the run "runSeed"
+    Crowd(uint64_t runSeed, const Rect& bounds, LevelGenerator generator, int levelIndex, int runners);
+
+    // One tick for every runner
+    void step();
+
+    const LevelData& level() const { return levelData; }
+    const std::vector<SimState>& runners() const { return states; }
+    uint64_t goalsReached() const { return goals; }
+    uint64_t deaths() const { return deathCount; }
+
+private:
+    // A runner's "brain": random keys held for a while, leaning towards the goal
+    struct Brain {
+        Rng rng;
+        uint8_t input;
+        uint8_t ticksLeft;
+    };
+
+    LevelData levelData;
+    ContactTracker contacts;                  // One grid for everybody
+    std::vector<SimState> states;
+    std::vector<ContactSet> contactSets;
+    std::vector<Brain> brains;
+    std::vector<ContactEvent> events;
+    uint64_t goals = 0;
+    uint64_t deathCount = 0;
+
+    uint8_t think(Brain& brain, const SimState& state);
+    void respawn(size_t runner);
+};
+
+#endif // CROWD_H
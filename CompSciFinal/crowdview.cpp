@@ -0,0 +1,116 @@
+#include "crowdview.h"
+
+#include <QStyleOptionGraphicsItem>
+
+#include "parallax.h"
+
+//-----------------------------------------
+CrowdItem::CrowdItem(const Crowd& crowd, const SpriteAtlas* atlas) : crowd(crowd), atlas(atlas) {
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+QRectF CrowdItem::boundingRect() const {
+    // Runners can jump above the top of the level
+    const Rect& b = crowd.level().bounds;
+    return QRectF(b.x, b.y - 200, b.w, b.h + 200).adjusted(-1, -1, 1, 1);
+}
+
+void CrowdItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    const double pen = LevelConfig::PenHalfWidth;
+    const double size = LevelConfig::PlayerSize + 2 * pen;
+
+    // Every runner in view is one piece of the batch, drawn in a single call
+    batch.clear();
+    batch.reserve(int(crowd.runners().size()));
+    for (const SimState& s : crowd.runners()) {
+        const QRectF target(s.x - pen, s.y - pen, size, size);
+        if (target.intersects(option->exposedRect)) atlas->addSprite(batch, SpritePlayer, target);
+    }
+    atlas->draw(*painter, batch);
+}
+
+//-----------------------------------------
+CrowdView::CrowdView(int runners, quint64 seed, LevelGenerator generator, QWidget* parent)
+    : QGraphicsView(parent), crowdScene(new QGraphicsScene(this)),
+      crowd(seed, worldBounds(), generator, 1, runners) {
+    crowdScene->setSceneRect(0, 0, LevelConfig::WorldWidth, LevelConfig::WorldHeight);
+    setScene(crowdScene);
+
+    // Level 1, not level 0: level 0 is the same for every generator
+    levelItem = new LevelItem(crowd.level(), &atlas);
+    crowdItem = new CrowdItem(crowd, &atlas);
+    crowdScene->addItem(levelItem);
+    crowdScene->addItem(crowdItem);
+
+    // Like GameView: starts 1:1 and scales to fit when resized
+    resize(int(LevelConfig::WorldWidth), int(LevelConfig::WorldHeight));
+    setMinimumSize(200, 100);
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    // Most of the window changes every frame, so skip working out what changed
+    setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+
+    timer = new QTimer(this);
+    timer->setInterval(SimConfig::TickMs);
+    connect(timer, &QTimer::timeout, this, &CrowdView::updateCrowd);
+}
+
+bool CrowdView::loadSpriteAtlas(const QString& path) {
+    if (!atlas.load(path)) return false;
+    crowdScene->update();
+    return true;
+}
+
+void CrowdView::showEvent(QShowEvent* event) {
+    QGraphicsView::showEvent(event);
+    if (!timer->isActive()) {
+        frameClock.start();
+        timer->start();
+    }
+}
+
+void CrowdView::resizeEvent(QResizeEvent* event) {
+    QGraphicsView::resizeEvent(event);
+    const QRectF world = crowdScene->sceneRect();
+    const double scale = qMin(viewport()->width() / world.width(), viewport()->height() / world.height());
+    setTransform(QTransform::fromScale(scale, scale));
+    centerOn(world.center());
+}
+
+//-----------------------------------------
+void CrowdView::updateCrowd() {
+    QElapsedTimer stepTimer;
+    stepTimer.start();
+    crowd.step();
+    stepMs = stepTimer.nsecsElapsed() / 1e6;
+
+    // The frame rate is smoothed so the number can be read
+    const double sinceLast = frameClock.restart();
+    frameMs = frameMs == 0 ? sinceLast : frameMs * 0.9 + sinceLast * 0.1;
+
+    crowdItem->update();
+    viewport()->update();
+}
+
+void CrowdView::drawBackground(QPainter* painter, const QRectF& rect) {
+    const QRectF camera = mapToScene(viewport()->rect()).boundingRect();
+    const quint32 tick = crowd.runners().empty() ? 0 : crowd.runners().front().tick;
+    ParallaxBackground::builtIn().draw(*painter, rect, camera, tick);
+}
+
+void CrowdView::drawForeground(QPainter* painter, const QRectF&) {
+    painter->save();
+    painter->resetTransform();
+    painter->setPen(Qt::black);
+    painter->drawText(QPointF(10, 20), QString("Runners: %1   Goals: %2   Deaths: %3")
+                                           .arg(crowd.runners().size())
+                                           .arg(crowd.goalsReached())
+                                           .arg(crowd.deaths()));
+    painter->drawText(QPointF(10, 40), QString("Step: %1 ms   Frame: %2 ms (%3 fps)")
+                                           .arg(stepMs, 0, 'f', 2)
+                                           .arg(frameMs, 0, 'f', 1)
+                                           .arg(frameMs > 0 ? 1000.0 / frameMs : 0.0, 0, 'f', 0));
+    painter->restore();
+}
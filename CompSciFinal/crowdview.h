@@ -0,0 +1,61 @@
+#ifndef CROWDVIEW_H
+#define CROWDVIEW_H
+
+// The window for crowd mode (--crowd N). The level is the usual LevelItem and
+// all the runners are one CrowdItem, which draws every runner's sprite in a
+// single batch. Scene items and paint calls stay the same for 10 runners or 10000.
+#include <QElapsedTimer>
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QTimer>
+
+#include "crowd.h"
+#include "gameview.h"               // LevelItem
+#include "spriteatlas.h"
+
+//-----------------------------------------
+class CrowdItem : public QGraphicsItem {
+public:
+    CrowdItem(const Crowd& crowd, const SpriteAtlas* atlas);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    const Crowd& crowd;
+    const SpriteAtlas* atlas;
+    SpriteBatch batch;   // Kept between frames to reuse its memory
+};
+
+//-----------------------------------------
+class CrowdView : public QGraphicsView {
+    Q_OBJECT
+
+public:
+    CrowdView(int runners, quint64 seed, LevelGenerator generator, QWidget* parent = nullptr);
+
+    bool loadSpriteAtlas(const QString& path);
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void drawForeground(QPainter* painter, const QRectF& rect) override;   // The stats
+
+private:
+    QGraphicsScene* crowdScene;
+    SpriteAtlas atlas;
+    Crowd crowd;
+    LevelItem* levelItem;
+    CrowdItem* crowdItem;
+    QTimer* timer;
+    QElapsedTimer frameClock;     // Time between frames, for the frame rate shown
+    double stepMs = 0;            // How long the last step of every runner took
+    double frameMs = 0;           // Smoothed time between frames
+
+private slots:
+    void updateCrowd();
+};
+
+#endif // CROWDVIEW_H
@@ -0,0 +1,72 @@
+#include "framepainter.h"
+
+#include "thumbnail.h"
+
+//-----------------------------------------
+// Small helper to turn level data into Qt shapes
+static QRectF toQRectF(const Rect& r) {
+    return QRectF(r.x, r.y, r.w, r.h);
+}
+
+//-----------------------------------------
+const QImage& TerrainLayer::image(const LevelData& level) {
+    if (cached.isNull() || terrain != level.terrain) {
+        terrain = level.terrain;
+        cached = QImage(int(level.bounds.w), int(level.bounds.h), QImage::Format_ARGB32);
+        cached.fill(Qt::transparent);
+        rasterizeTerrain(level, reinterpret_cast<uint32_t*>(cached.bits()), cached.width(), cached.height(),
+                         int(cached.bytesPerLine() / 4), ThumbnailColors::Ground);
+    }
+    return cached;
+}
+
+//-----------------------------------------
+// Draw in the same order the scene stacks its items:
+// background, terrain, player, HUD text, then the level on top.
+void paintFrame(QPainter& painter, const LevelData& level, const SimState& state, TerrainLayer* terrain,
+                const SpriteAtlas& sprites, const ParallaxBackground& background) {
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing, false);
+    painter.setPen(QPen(Qt::black, 1));
+
+    // The sky and its parallax layers (the whole level is in view, so it is the camera)
+    background.draw(painter, toQRectF(level.bounds), toQRectF(level.bounds), state.tick);
+
+    // The terrain (the level item draws it first, under the sprites)
+    if (!level.terrain.empty()) {
+        TerrainLayer uncached;
+        painter.drawImage(QPointF(level.bounds.x, level.bounds.y), (terrain ? terrain : &uncached)->image(level));
+    }
+
+    // The player sprite, over the player's rect and its outline
+    const double pen = LevelConfig::PenHalfWidth;
+    SpriteBatch batch;
+    sprites.addSprite(batch, SpritePlayer, QRectF(state.x - pen, state.y - pen, LevelConfig::PlayerSize + 2 * pen,
+                                                  LevelConfig::PlayerSize + 2 * pen));
+    sprites.draw(painter, batch);
+
+    // HUD text (QGraphicsTextItem adds a 4px margin around its text)
+    painter.drawText(QPointF(14, 14 + painter.fontMetrics().ascent()),
+                     QString("Lives left: %1").arg(SimConfig::MaxDeaths - state.deaths));
+    painter.drawText(QPointF(14, 34 + painter.fontMetrics().ascent()),
+                     QString("Levels won: %1").arg(state.level));
+
+    // Platforms, spikes and the goal, in one batch
+    batch.clear();
+    sprites.addLevel(batch, level, toQRectF(level.bounds).adjusted(-pen, -pen, pen, pen));
+    sprites.draw(painter, batch);
+
+    // The red "Game Over" message in the centre
+    if (state.deaths >= SimConfig::MaxDeaths) {
+        QFont font;
+        font.setPointSize(24);
+        font.setBold(true);
+        painter.setFont(font);
+        painter.setPen(Qt::red);
+        const QRectF textRect(level.bounds.w / 2 - 146, level.bounds.h / 2 - 46, 400, 100);
+        painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop,
+                         QString("Game Over!\nYou passed %1 levels.").arg(state.level));
+    }
+
+    painter.restore();
+}
@@ -0,0 +1,33 @@
+#ifndef FRAMEPAINTER_H
+#define FRAMEPAINTER_H
+
+// Draws one frame of the game straight from level data and simulation state,
+// looking the same as the GameView scene. It only needs a QPainter, so it
+// works on a QImage in any thread with no window or QGraphicsScene.
+#include <QImage>
+#include <QPainter>
+
+#include <vector>
+
+#include "parallax.h"
+#include "simulation.h"
+#include "spriteatlas.h"
+
+//-----------------------------------------
+// The level's terrain drawn once into an image, and only drawn again when the
+// terrain changes (a new level). Keep one per thread that paints frames.
+class TerrainLayer {
+public:
+    const QImage& image(const LevelData& level);
+
+private:
+    std::vector<float> terrain;   // The terrain "cached" was drawn from
+    QImage cached;
+};
+
+// "terrain" is optional: without it the terrain is drawn again every frame
+void paintFrame(QPainter& painter, const LevelData& level, const SimState& state, TerrainLayer* terrain = nullptr,
+                const SpriteAtlas& sprites = SpriteAtlas::builtIn(),
+                const ParallaxBackground& background = ParallaxBackground::builtIn());
+
+#endif // FRAMEPAINTER_H
@@ -0,0 +1,522 @@
+#include "gameview.h"
+
+#include <QElapsedTimer>
+#include <QFont>
+#include <QLineF>
+#include <QStyleOptionGraphicsItem>
+
+#include <cmath>
+
+#include "metrics.h"                // Counters for the /metrics endpoint
+#include "terrain.h"                // Ground height under the player
+#include "thumbnail.h"              // Draws the terrain into an image
+
+//-----------------------------------------
+void Player::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*) {
+    batch.clear();
+    atlas->addSprite(batch, SpritePlayer, boundingRect());
+    atlas->draw(*painter, batch);
+
+    // A coloured square in the middle tells players apart
+    if (tint.isValid()) painter->fillRect(rect().adjusted(6, 6, -6, -6), tint);
+}
+
+//-----------------------------------------
+LevelItem::LevelItem(const LevelData& level, const SpriteAtlas* atlas) : level(level), atlas(atlas) {
+    // exposedRect tells paint() which part of the scene is being redrawn
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+QRectF LevelItem::boundingRect() const {
+    // The level plus the outline of anything on its edge
+    const double pen = LevelConfig::PenHalfWidth;
+    return QRectF(level.bounds.x, level.bounds.y, level.bounds.w, level.bounds.h).adjusted(-pen, -pen, pen, pen);
+}
+
+void LevelItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    // The terrain picture has one pixel per screen pixel (HiDPI screens
+    // included), so it is drawn again only when the window scale changes
+    if (!level.terrain.empty()) {
+        const double scale = option->levelOfDetailFromTransform(painter->worldTransform()) *
+                             painter->device()->devicePixelRatioF();
+        if (terrain.isNull() || std::abs(scale - terrainScale) > 1e-3) {
+            const QSize size(qMax(1, qRound(level.bounds.w * scale)), qMax(1, qRound(level.bounds.h * scale)));
+            QImage image(size, QImage::Format_ARGB32);
+            image.fill(Qt::transparent);
+            rasterizeTerrain(level, reinterpret_cast<uint32_t*>(image.bits()), image.width(), image.height(),
+                             int(image.bytesPerLine() / 4), ThumbnailColors::Ground);
+            terrain = QPixmap::fromImage(image);
+            terrain.setDevicePixelRatio(scale);
+            terrainScale = scale;
+        }
+        painter->drawPixmap(QPointF(level.bounds.x, level.bounds.y), terrain);
+    }
+
+    batch.clear();
+    atlas->addLevel(batch, level, option->exposedRect);
+    atlas->draw(*painter, batch);
+}
+
+//-----------------------------------------
+GameView::GameView(QGraphicsScene* scene, quint64 seed, const QString& recordPath, LevelGenerator generator)
+    : QGraphicsView(scene), player(new Player(&atlas)), levelItem(nullptr), verticalVelocity(0), deaths(0), level(0),
+      gameOverText(nullptr), runSeed(seed), levelGenerator(generator), recordPath(recordPath), firstFramePainted(false),
+      quartersPerFrame(4), quarterTicks(0) {
+
+    // Start with one screen pixel per world unit. The window can be resized;
+    // the world keeps its size and is scaled to fit (see resizeEvent()).
+    resize(int(scene->sceneRect().width()), int(scene->sceneRect().height()));
+    setMinimumSize(200, 100);
+
+    // No frame, so at the starting size the viewport is exactly the world
+    setFrameShape(QFrame::NoFrame);
+
+    // Sprites are scaled with the window, so smooth them
+    setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    // Ensure the window can receive keyboard input
+    setFocusPolicy(Qt::StrongFocus);
+
+    // Remove scrollbars (we don't want to scroll around the scene)
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    // Add player to the scene
+    scene->addItem(player);
+
+    // Create on-screen text for lives and level
+    livesText = new QGraphicsTextItem();
+    levelsText = new QGraphicsTextItem();
+    scene->addItem(livesText);
+    scene->addItem(levelsText);
+    livesText->setPos(10, 10);
+    levelsText->setPos(10, 30);
+
+    // The timer updates the game 60 times per second (1000ms / 16 ≈ 60fps).
+    // It is started by the first paint, so the game only runs once it can be seen.
+    moveTimer = new QTimer(this);
+    moveTimer->setInterval(SimConfig::TickMs);
+    connect(moveTimer, &QTimer::timeout, this, &GameView::runFrame);
+
+    // The background is drawn by drawBackground() from the cached parallax layers.
+    // Nothing is cached by the view itself, because the layers move.
+    setCacheMode(QGraphicsView::CacheNone);
+
+    // Remember what the run needs to be replayed later
+    recording.seed = runSeed;
+    recording.generator = levelGenerator;
+    recording.width = scene->sceneRect().width();
+    recording.height = scene->sceneRect().height();
+
+    // Generate the first level
+    generateLevel();
+}
+
+GameView::~GameView() {
+    // Save the recorded inputs so tools can replay this run
+    if (!recordPath.isEmpty()) saveReplay(recordPath.toStdString(), recording);
+}
+
+// Whenever a key is pressed, record it
+void GameView::keyPressEvent(QKeyEvent* event) {
+    keysPressed.insert(event->key());
+
+    // Speed keys (not part of the replay input, they don't change what happens).
+    // One step per press: holding a key would otherwise race to the fastest or slowest speed.
+    if (event->isAutoRepeat()) return;
+    const int power = qRound(std::log2(speed()));
+    if (event->key() == Qt::Key_Plus || event->key() == Qt::Key_Equal) setSpeed(power + 1);
+    if (event->key() == Qt::Key_Minus) setSpeed(power - 1);
+    if (event->key() == Qt::Key_0) setSpeed(0);
+}
+
+// Whenever a key is released, stop tracking it
+void GameView::keyReleaseEvent(QKeyEvent* event) {
+    keysPressed.remove(event->key());
+}
+
+// The first paint ends startup: start the game clock and let main() know
+void GameView::paintEvent(QPaintEvent* event) {
+    QGraphicsView::paintEvent(event);
+    if (firstFramePainted) return;
+
+    firstFramePainted = true;
+    if (!inputSource) moveTimer->start();
+    emit firstFrameShown();
+}
+
+// The sky: the parallax layers placed for the part of the scene in view
+void GameView::drawBackground(QPainter* painter, const QRectF& rect) {
+    const QRectF camera = mapToScene(viewport()->rect()).boundingRect();
+    ParallaxBackground::builtIn().draw(*painter, rect, camera, quint32(recording.inputs.size()));
+}
+
+// The speed when it isn't normal and, in time attack, the clock in the top right
+// corner with the split of every level won so far and how far ahead (green) or
+// behind (red) of the personal best
+void GameView::drawForeground(QPainter* painter, const QRectF&) {
+    // Drawn in window pixels, so it stays the same size when the window is scaled
+    painter->save();
+    painter->resetTransform();
+
+    // The speed, when it isn't normal
+    if (quartersPerFrame != 4) {
+        painter->setPen(Qt::black);
+        painter->drawText(QRectF(0, 10, viewport()->width(), 20), Qt::AlignHCenter | Qt::AlignVCenter,
+                          QString("Speed %1x").arg(speed()));
+    }
+
+    if (speedrun.levels() == 0) {
+        painter->restore();
+        return;
+    }
+    const int right = viewport()->width() - 10;
+    const quint32 tick = quint32(recording.inputs.size());
+
+    QFont font;
+    font.setPointSize(16);
+    font.setBold(true);
+    painter->setFont(font);
+    painter->setPen(speedrun.isNewBest() ? Qt::darkGreen : Qt::black);
+    painter->drawText(QRectF(0, 5, right, 30), Qt::AlignRight | Qt::AlignVCenter,
+                      QString::fromStdString(formatRunTime(speedrun.elapsedMs(tick))));
+
+    painter->setFont(QFont());
+    const std::vector<double>& splits = speedrun.splitTimes();
+    for (int i = 0; i < int(splits.size()); ++i) {
+        const double y = 40 + 18 * i;
+        painter->setPen(Qt::black);
+        painter->drawText(QRectF(0, y, right - 60, 18), Qt::AlignRight | Qt::AlignVCenter,
+                          QString("Level %1   %2").arg(i + 1).arg(QString::fromStdString(formatRunTime(splits[size_t(i)]))));
+        if (speedrun.hasBestFor(i)) {
+            const double delta = speedrun.deltaMs(i);
+            painter->setPen(delta < 0 ? Qt::darkGreen : Qt::red);
+            painter->drawText(QRectF(0, y, right, 18), Qt::AlignRight | Qt::AlignVCenter,
+                              QString::fromStdString(formatTimeDelta(delta)));
+        }
+    }
+
+    const std::vector<double>& best = speedrun.personalBest();
+    painter->setPen(Qt::darkGray);
+    painter->drawText(QRectF(0, 40 + 18 * splits.size(), right, 18), Qt::AlignRight | Qt::AlignVCenter,
+                      best.empty() ? QString("No personal best yet")
+                                   : QString("Best %1").arg(QString::fromStdString(formatRunTime(best.back()))));
+    if (speedrun.isNewBest()) {
+        painter->setPen(Qt::darkGreen);
+        painter->drawText(QRectF(0, 58 + 18 * splits.size(), right, 18), Qt::AlignRight | Qt::AlignVCenter,
+                          QString("New personal best!"));
+    }
+    painter->restore();
+}
+
+// Scale the world to fit the window. The scene (and so the level, the physics
+// and replays) stays in world units; only the view transform changes, and the
+// cached pictures are redrawn at the new size the next time they are painted.
+void GameView::resizeEvent(QResizeEvent* event) {
+    QGraphicsView::resizeEvent(event);
+
+    // Not fitInView(): it leaves a small margin, so the starting size would not be 1:1
+    const QRectF world = scene()->sceneRect();
+    const double scale = qMin(viewport()->width() / world.width(), viewport()->height() / world.height());
+    setTransform(QTransform::fromScale(scale, scale));
+    centerOn(world.center());
+}
+
+//-----------------------------------------
+// The keys held right now as replay input bits
+quint8 GameView::currentInput() const {
+    if (inputSource) return inputSource();
+
+    quint8 input = 0;
+    if (keysPressed.contains(Qt::Key_A)) input |= InputLeft;
+    if (keysPressed.contains(Qt::Key_D)) input |= InputRight;
+    if (keysPressed.contains(Qt::Key_W)) input |= InputJump;
+    return input;
+}
+
+//-----------------------------------------
+// This function builds or resets the level layout
+void GameView::generateLevel() {
+    QElapsedTimer generationTimer;
+    generationTimer.start();
+
+    // Remove the old level (removeItem() gives it back to us, so delete it too)
+    if (levelItem) scene()->removeItem(levelItem);
+    delete levelItem;
+    levelItem = nullptr;
+
+    // Remove the game over screen if it's still showing
+    if (gameOverText) {
+        scene()->removeItem(gameOverText);
+        delete gameOverText;
+        gameOverText = nullptr;
+    }
+
+    // Get the layout for this level from the run seed
+    QRectF sceneBounds = scene()->sceneRect();
+    levelData = generateLevelData(runSeed, level, Rect{0, 0, sceneBounds.width(), sceneBounds.height()},
+                                  levelGenerator);
+    const LevelData& data = levelData;
+    contacts.build(data);
+
+    // The player always starts (and respawns) at the level's spawn point
+    QPointF spawnPos(data.spawn.x, data.spawn.y);
+    if (level == 0 || lastSpawnPos.isNull()) lastSpawnPos = spawnPos;
+    checkpoint = Checkpoint{};   // Checkpoints only count on their own level
+
+    // The whole level is one item, drawn from the sprite atlas
+    levelItem = new LevelItem(data, &atlas);
+    scene()->addItem(levelItem);
+
+    // Move the player to the start
+    player->setPos(spawnPos);
+
+    // Update the heads-up display text
+    updateHUD();
+
+    // Levels are the only time items are added or removed, so count them here
+    gameMetrics().levelsGenerated.fetch_add(1, std::memory_order_relaxed);
+    gameMetrics().sceneItems.store(scene()->items().size(), std::memory_order_relaxed);
+    gameMetrics().generationDuration.observe(generationTimer.nsecsElapsed());
+}
+
+//-----------------------------------------
+// Automated play: the caller decides when ticks happen and what is pressed
+void GameView::takeControl(std::function<quint8()> input) {
+    moveTimer->stop();
+    inputSource = std::move(input);
+}
+
+void GameView::advance(int ticks) {
+    if (ticks <= 0) return;
+    for (int i = 0; i < ticks; ++i) updatePosition();
+    drawFrame();
+}
+
+//-----------------------------------------
+// Speed
+void GameView::setSpeed(int power) {
+    quartersPerFrame = 1 << (qBound(GameSpeed::Slowest, power, GameSpeed::Fastest) + 2);
+    quarterTicks = 0;
+    viewport()->update();
+}
+
+// Slow motion runs a tick every few frames, fast forward several per frame
+int GameView::takeFrameTicks() {
+    quarterTicks += quartersPerFrame;
+    const int ticks = quarterTicks / 4;
+    quarterTicks %= 4;
+    return ticks;
+}
+
+// The timer: this frame's ticks, then one redraw. At 16x the 15 states in
+// between are never drawn, so fast forward costs little more than the ticks.
+void GameView::runFrame() {
+    advance(takeFrameTicks());
+}
+
+void GameView::skipLevel() {
+    level++;
+    generateLevel();
+}
+
+void GameView::restartRun() {
+    speedrun.reset();
+    level = 0;
+    deaths = 0;
+    verticalVelocity = 0;
+    generateLevel();
+}
+
+SimState GameView::simState() const {
+    SimState state;
+    state.x = player->pos().x();
+    state.y = player->pos().y();
+    state.verticalVelocity = verticalVelocity;
+    state.deaths = deaths;
+    state.level = level;
+    state.tick = quint32(recording.inputs.size());
+    state.checkpoint = checkpoint;
+    return state;
+}
+
+int GameView::sceneItemCount() const {
+    return scene()->items().size();
+}
+
+bool GameView::loadSpriteAtlas(const QString& path) {
+    if (!atlas.load(path)) return false;
+    scene()->update();
+    return true;
+}
+
+void GameView::setTimeAttack(int levels, const QString& path) {
+    speedrun = SpeedrunTimer(levels);
+    bestsPath = path;
+
+    // No file yet just means no personal bests yet
+    personalBests.clear();
+    loadPersonalBests(bestsPath.toStdString(), personalBests);
+    if (const PersonalBest* best = findPersonalBest(personalBests, runSeed, levelGenerator, levels))
+        speedrun.setPersonalBest(best->splits);
+}
+
+//-----------------------------------------
+// Updates the "Lives left" and "Levels won" text
+void GameView::updateHUD() {
+    livesText->setPlainText(QString("Lives left: %1").arg(10 - deaths));
+    levelsText->setPlainText(QString("Levels won: %1").arg(level));
+}
+
+//-----------------------------------------
+// Show a red "Game Over" message in the center
+void GameView::showGameOver() {
+    gameOverText = new QGraphicsTextItem();
+    gameOverText->setPlainText(QString("Game Over!\nYou passed %1 levels.").arg(level));
+    QFont font;
+    font.setPointSize(24);
+    font.setBold(true);
+    gameOverText->setFont(font);
+    gameOverText->setDefaultTextColor(Qt::red);
+    gameOverText->setPos(scene()->width() / 2 - 150, scene()->height() / 2 - 50);
+    scene()->addItem(gameOverText);
+}
+
+//-----------------------------------------
+// The last goal of a time attack: save the run if it beat the personal best
+void GameView::finishTimeAttack() {
+    if (!speedrun.isNewBest()) return;
+
+    PersonalBest* best = findPersonalBest(personalBests, runSeed, levelGenerator, speedrun.levels());
+    if (!best) {
+        personalBests.push_back(PersonalBest{runSeed, levelGenerator, speedrun.levels(), {}});
+        best = &personalBests.back();
+    }
+    best->splits = speedrun.splitTimes();
+    if (!savePersonalBests(bestsPath.toStdString(), personalBests))
+        qWarning("Could not save personal bests to %s", qPrintable(bestsPath));
+}
+
+//-----------------------------------------
+// The main game loop, called ~60 times per second
+void GameView::updatePosition() {
+    QElapsedTimer tickTimer;
+    tickTimer.start();
+    gameMetrics().ticks.fetch_add(1, std::memory_order_relaxed);
+
+    // Read this tick's input once (the keys, or whoever has taken control) and
+    // record it so the run can be replayed
+    const quint8 input = currentInput();
+    recording.inputs.push_back(input);
+
+    // Stop the game if the player has died too many times
+    if (deaths >= 10) {
+        if (!gameOverText) {
+            showGameOver();
+        }
+        return;
+    }
+
+    // A finished time attack stays on its final time
+    if (speedrun.finished()) return;
+
+    // Store the player's current position and size
+    const QPointF startPos = player->pos();
+    QPointF currentPos = startPos;
+    QRectF sceneBounds = scene()->sceneRect();
+    QRectF playerRect = player->boundingRect();
+
+    // Move left and right
+    if (input & InputRight) currentPos.setX(currentPos.x() + 7);
+    if (input & InputLeft) currentPos.setX(currentPos.x() - 7);
+
+    // Simulate gravity by reducing upward velocity
+    verticalVelocity -= 1;
+    QPointF nextPos = currentPos;
+    nextPos.setY(currentPos.y() - verticalVelocity); // Y is inverted in Qt
+
+    bool onGround = false;
+
+    // Check for collision with any platform (with the half pixel of outline
+    // each platform item used to have, as the Simulation does)
+    for (const Rect& platform : levelData.platforms) {
+        const Rect p = platform.adjusted(LevelConfig::PenHalfWidth);
+        QRectF platRect(p.x, p.y, p.w, p.h);
+        QRectF playerNextRect(nextPos, playerRect.size());
+
+        // Only land if falling down and above the platform
+        if (playerNextRect.intersects(platRect) && verticalVelocity <= 0 &&
+            currentPos.y() + playerRect.height() <= platRect.top()) {
+            nextPos.setY(platRect.top() - playerRect.height());
+            verticalVelocity = 0;
+            onGround = true;
+            break;
+        }
+    }
+
+    // Stop the fall if player hits the ground (the bottom of the scene, or the terrain under it)
+    const double ground = groundTop(levelData, nextPos.x(), playerRect.width());
+    if (nextPos.y() >= ground - playerRect.height()) {
+        nextPos.setY(ground - playerRect.height());
+        onGround = true;
+        verticalVelocity = 0;
+    }
+
+    // Jump when pressing W while on ground
+    if ((input & InputJump) && onGround) {
+        verticalVelocity = 20;
+    }
+
+    // Prevent the player from leaving screen horizontally
+    nextPos.setX(qBound(sceneBounds.left(), nextPos.x(), sceneBounds.right() - playerRect.width()));
+    player->setPos(nextPos);
+
+    // Find what the player started touching (only the goal and spikes near it are tested)
+    contacts.update(nextPos.x(), nextPos.y(), contactEvents);
+
+    // Check for winning
+    const bool won = contactEntered(contactEvents, ContactGoal);
+    if (won) {
+        // The exact moment within this tick the goal was touched, for the split
+        speedrun.goalReached(quint32(recording.inputs.size()),
+                             goalTouchFraction(startPos.x(), startPos.y(), nextPos.x(), nextPos.y(), levelData.goal));
+        if (speedrun.finished()) finishTimeAttack();
+
+        level++;
+        generateLevel();
+        contacts.update(player->pos().x(), player->pos().y(), contactEvents);   // The new level, at the spawn point
+    }
+
+    // Check for hitting a spike: back to the last checkpoint exactly as it was
+    // touched, or to the spawn point if there hasn't been one on this level
+    const bool died = contactEntered(contactEvents, ContactSpike);
+    if (died) {
+        deaths++;
+        gameMetrics().deaths.fetch_add(1, std::memory_order_relaxed);
+        if (checkpoint.index < 0) {
+            player->setPos(lastSpawnPos);
+        } else {
+            player->setPos(checkpoint.x, checkpoint.y);
+            verticalVelocity = checkpoint.verticalVelocity;
+        }
+        contacts.reset();
+    }
+
+    // Check for a new checkpoint (never on a tick the player won or died, so the
+    // snapshot is never touching a spike)
+    if (!won && !died) {
+        SimState now = simState();
+        if (saveCheckpoint(now, contactEvents)) checkpoint = now.checkpoint;
+    }
+
+    gameMetrics().tickDuration.observe(tickTimer.nsecsElapsed());
+}
+
+// After the ticks of a frame: the HUD and anything that moves with the tick count
+void GameView::drawFrame() {
+    // Update UI text
+    updateHUD();
+
+    // Drifting layers have moved (or the timer has), so the whole window needs drawing again
+    if (ParallaxBackground::builtIn().animated() || speedrun.levels() > 0) viewport()->update();
+}
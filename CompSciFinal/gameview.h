@@ -0,0 +1,162 @@
+#ifndef GAMEVIEW_H
+#define GAMEVIEW_H
+
+// These are all the necessary Qt libraries we need to use graphics, keyboard input, timers, and more.
+#include <QGraphicsScene>           // The "world" where all game objects live
+#include <QGraphicsView>            // The window/frame that shows part of the scene
+#include <QGraphicsRectItem>        // A rectangular game object (like our player)
+#include <QGraphicsTextItem>        // Used to draw text (like lives and level count)
+#include <QPixmap>                  // The terrain, drawn once per level
+#include <QKeyEvent>                // Handles key presses
+#include <QTimer>                   // Lets us run code repeatedly, like a game loop
+#include <QSet>                     // Stores keys being pressed
+#include <QString>
+
+#include <functional>
+
+#include "contacts.h"               // Which items the player touches
+#include "level.h"                  // Seeded level layouts
+#include "parallax.h"               // The sky behind the level
+#include "replay.h"                 // Recording the inputs of a run
+#include "simulation.h"             // SimState, the game state in plain numbers
+#include "speedrun.h"               // Time attack timer and personal bests
+#include "spriteatlas.h"            // The art for the player and level
+
+//-----------------------------------------
+// This class represents the player character.
+// It's a 20x20 square that the user controls, drawn with the player sprite.
+class Player : public QGraphicsRectItem {
+public:
+    explicit Player(const SpriteAtlas* atlas) : atlas(atlas) {
+        setRect(0, 0, LevelConfig::PlayerSize, LevelConfig::PlayerSize);   // Set width and height to 20x20 pixels
+    }
+
+    void setTint(const QColor& color) { tint = color; update(); }
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    const SpriteAtlas* atlas;
+    SpriteBatch batch;
+    QColor tint;   // Marks the player in multiplayer games (none by default)
+};
+
+//-----------------------------------------
+// The whole level (terrain, platforms, spikes and the goal) as one item. It
+// draws only the sprites in the part of the scene being repainted, all in one
+// batch, so a level with thousands of platforms is still one item.
+class LevelItem : public QGraphicsItem {
+public:
+    LevelItem(const LevelData& level, const SpriteAtlas* atlas);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    const LevelData& level;   // GameView's levelData (the item is replaced with each level)
+    const SpriteAtlas* atlas;
+    QPixmap terrain;          // The terrain is thousands of columns, so it is drawn once into a picture
+    double terrainScale = 0;  // Screen pixels per world unit "terrain" was drawn for
+    SpriteBatch batch;        // Kept between paints to reuse its memory
+};
+
+//-----------------------------------------
+// Game speed for practice and watching replays. The timer always fires every
+// TickMs; the speed only changes how many ticks each timer "frame" runs, so a
+// run plays out exactly the same at any speed.
+namespace GameSpeed {
+    constexpr int Slowest = -2;    // 0.25x: one tick every 4 frames
+    constexpr int Fastest = 4;     // 16x: 16 ticks per frame, drawn once
+}
+
+//-----------------------------------------
+// GameView is the main window and game controller.
+// It handles drawing, physics, input, and level generation.
+class GameView : public QGraphicsView {
+    Q_OBJECT
+
+public:
+    // "seed" picks the run's levels and "generator" how they are built;
+    // if "recordPath" is set the inputs are saved there on exit
+    GameView(QGraphicsScene* scene, quint64 seed, const QString& recordPath = QString(),
+             LevelGenerator generator = LevelGenerator::Classic);
+    ~GameView() override;
+
+    //-----------------------------------------
+    // Automated play (used by the soak test)
+    void takeControl(std::function<quint8()> input);   // Stop the timer and read input from "input"
+    void advance(int ticks = 1);                       // Run game ticks right now, then draw once
+    void skipLevel();                                  // Count the level as won and build the next one
+    void restartRun();                                 // Back to level 0 with all lives
+    SimState simState() const;                         // The game state as the Simulation sees it
+    const LevelData& currentLevel() const { return levelData; }
+    LevelGenerator generator() const { return levelGenerator; }
+    int sceneItemCount() const;
+
+    // Draw with the art in this image file (see spriteatlas.h for its layout)
+    bool loadSpriteAtlas(const QString& path);
+
+    // Time attack: the run ends after "levels" levels, with a timer, splits and
+    // the personal best for this seed kept in the file "bestsPath"
+    void setTimeAttack(int levels, const QString& bestsPath);
+
+    // Speed is 2^"power" (GameSpeed::Slowest to GameSpeed::Fastest, 0 = normal).
+    // The + and - keys change it while playing, 0 puts it back to normal.
+    void setSpeed(int power);
+    double speed() const { return quartersPerFrame / 4.0; }
+    int takeFrameTicks();                              // Ticks due this frame at the current speed
+
+signals:
+    // The window has been drawn for the first time
+    void firstFrameShown();
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+    void keyReleaseEvent(QKeyEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void drawForeground(QPainter* painter, const QRectF& rect) override;   // The time attack timer
+
+private:
+    // Game elements
+    SpriteAtlas atlas;                              // The art everything is drawn with
+    Player* player;
+    LevelItem* levelItem;                           // Platforms, spikes, goal and terrain of this level
+    QTimer* moveTimer;                              // The game loop
+    QSet<int> keysPressed;                          // Set of currently pressed keys
+    int verticalVelocity;                           // Used for jumping and falling
+    int deaths;                                     // Number of times the player hit a spike
+    int level;                                      // Number of levels completed
+    QGraphicsTextItem* livesText;                   // HUD text
+    QGraphicsTextItem* levelsText;
+    QPointF lastSpawnPos;                           // Where to respawn the player before any checkpoint
+    Checkpoint checkpoint;                          // The last checkpoint touched on this level (see simulation.h)
+    QGraphicsTextItem* gameOverText;                // Text shown on game over
+    quint64 runSeed;                                // Seed every level of this run comes from
+    LevelGenerator levelGenerator;                  // Which generator builds the levels
+    Replay recording;                               // Inputs of every tick so far
+    QString recordPath;                             // Where to save the recording (empty = don't)
+    LevelData levelData;                            // Layout of the current level
+    ContactTracker contacts;                        // Finds the goal and spikes near the player
+    std::vector<ContactEvent> contactEvents;        // What the player started or stopped touching this tick
+    std::function<quint8()> inputSource;            // Replaces the keyboard when set
+    bool firstFramePainted;                         // Startup is over once this is true
+    SpeedrunTimer speedrun;                         // Split times of this run (from ticks, not the clock)
+    QString bestsPath;                              // Where personal bests are kept (time attack only)
+    std::vector<PersonalBest> personalBests;
+    int quartersPerFrame;                           // Quarter ticks per frame (4 = normal speed)
+    int quarterTicks;                               // Quarter ticks owed to the next frame
+
+    void generateLevel();
+    void updateHUD();
+    void showGameOver();
+    void finishTimeAttack();
+    void updatePosition();                          // One game tick
+    void drawFrame();                               // Show the state after this frame's ticks
+    quint8 currentInput() const;
+
+private slots:
+    void runFrame();
+};
+
+#endif // GAMEVIEW_H
@@ -0,0 +1,183 @@
+#include "level.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "chunkgenerator.h"
+#include "pathgenerator.h"
+#include "terrain.h"
+
+//-----------------------------------------
+// Each level gets its own seed so we can jump straight to any level of a run
+// without generating all the levels before it.
+uint64_t levelSeed(uint64_t runSeed, int levelIndex) {
+    Rng mixer(runSeed ^ (uint64_t(levelIndex) * 0xD1B54A32D192ED03ull));
+    return mixer.next();
+}
+
+//-----------------------------------------
+const char* generatorName(LevelGenerator generator) {
+    switch (generator) {
+    case LevelGenerator::Classic: return "classic";
+    case LevelGenerator::PathFirst: return "path";
+    case LevelGenerator::Chunks: return "chunks";
+    case LevelGenerator::Hills: return "hills";
+    }
+    return "unknown";
+}
+
+bool parseGenerator(const std::string& name, LevelGenerator& generator) {
+    for (uint8_t g = 0; g < LevelGeneratorCount; ++g) {
+        if (name == generatorName(LevelGenerator(g))) {
+            generator = LevelGenerator(g);
+            return true;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------
+// Path-first platforms with hills under them. The chain already keeps clear of
+// the lowest FloorClearance pixels, which is more than the hills rise, but a
+// spike on a low platform could now touch the player walking over a hill, so
+// those spikes are left out.
+static LevelData generateHillsLevel(uint64_t runSeed, int levelIndex, const Rect& bounds) {
+    LevelData level = generatePathFirstLevel(runSeed, levelIndex, bounds);
+    addTerrain(level, levelSeed(runSeed, levelIndex) ^ 0x48494C4C53ull);
+
+    const double lowestSafe = bounds.bottom() - TerrainConfig::Amplitude - LevelConfig::PlayerSize - 5;
+    level.spikes.erase(std::remove_if(level.spikes.begin(), level.spikes.end(),
+                                      [&](const Triangle& t) { return t.left.y > lowestSafe; }),
+                       level.spikes.end());
+    return level;
+}
+
+//-----------------------------------------
+// Checkpoints go on platforms without a spike, spread evenly along the way
+// from the spawn point to the goal: the longer the way, the more checkpoints.
+static void addCheckpoints(LevelData& level) {
+    using namespace LevelConfig;
+
+    const double dx = level.goal.x + level.goal.w / 2 - level.spawn.x;
+    const double dy = level.goal.y + level.goal.h / 2 - level.spawn.y;
+    const double lengthSquared = dx * dx + dy * dy;
+    const int count = int(std::sqrt(lengthSquared) / CheckpointSpacing);
+    if (count == 0) return;
+
+    auto hasSpike = [&](const Rect& p) {
+        for (const Triangle& t : level.spikes)
+            if (t.left.y == p.y && t.right.x > p.x && t.left.x < p.right()) return true;
+        return false;
+    };
+    auto flagOn = [](const Rect& p) {
+        return Rect{p.x + p.w / 2 - CheckpointWidth / 2, p.y - CheckpointHeight, CheckpointWidth, CheckpointHeight};
+    };
+    auto blocked = [&](const Rect& flag) {
+        if (flag.intersects(level.goal)) return true;
+        for (const Triangle& t : level.spikes)
+            if (flag.intersects(Rect{t.left.x, t.apex.y, t.right.x - t.left.x, t.left.y - t.apex.y})) return true;
+        return false;
+    };
+
+    // Checkpoint k (1 to count) wants to be k / (count + 1) of the way from
+    // spawn (0) to goal (1). Each platform can only be the one for the nearest
+    // place, so one pass finds the closest free platform for every checkpoint.
+    struct Slot {
+        double distance = 0.5;     // In "places": more than half way to a neighbour's place is too far
+        const Rect* platform = nullptr;
+    };
+    std::vector<Slot> slots(static_cast<size_t>(count));
+    const double scale = (count + 1) / lengthSquared;
+    for (const Rect& p : level.platforms) {
+        const double place = ((p.x + p.w / 2 - level.spawn.x) * dx + (p.y - level.spawn.y) * dy) * scale;
+        const int nearest = int(std::floor(place + 0.5));
+        if (nearest < 1 || nearest > count) continue;
+
+        Slot& slot = slots[size_t(nearest - 1)];
+        const double distance = std::abs(place - double(nearest));
+        if (distance < slot.distance && !hasSpike(p) && !blocked(flagOn(p))) slot = Slot{distance, &p};
+    }
+
+    for (const Slot& slot : slots)
+        if (slot.platform) level.checkpoints.push_back(flagOn(*slot.platform));
+}
+
+//-----------------------------------------
+// The classic generator is the same layout algorithm the game has always used,
+// just writing into plain data instead of creating QGraphicsItems.
+static LevelData generateLayout(uint64_t runSeed, int levelIndex, const Rect& bounds, LevelGenerator generator) {
+    using namespace LevelConfig;
+
+    // The starting room is the same for every generator
+    if (generator == LevelGenerator::PathFirst && levelIndex > 0)
+        return generatePathFirstLevel(runSeed, levelIndex, bounds);
+    if (generator == LevelGenerator::Chunks && levelIndex > 0)
+        return generateChunkLevel(runSeed, levelIndex, bounds);
+    if (generator == LevelGenerator::Hills && levelIndex > 0)
+        return generateHillsLevel(runSeed, levelIndex, bounds);
+
+    LevelData level;
+    level.bounds = bounds;
+
+    // The player always spawns in the middle bottom of the scene
+    level.spawn = Vec2{bounds.w / 2, bounds.h - PlayerSize};
+    const Vec2 spawnPos = level.spawn;
+
+    if (levelIndex == 0) {
+        // First level: the goal sits near the bottom, left of the player
+        level.goal = Rect{bounds.w / 2 - 100, bounds.h - 50, GoalSize, GoalSize};
+
+        // Create a platform directly under spawn
+        level.platforms.push_back(Rect{spawnPos.x - 40, spawnPos.y + 20, BasePlatformWidth, PlatformHeight});
+        return level;
+    }
+
+    Rng rng(levelSeed(runSeed, levelIndex));
+
+    // For new levels: generate a random goal position far from the player
+    Vec2 winPos;
+    do {
+        winPos = Vec2{rng.bounded(bounds.w), rng.bounded(bounds.h / 2)};
+    } while (std::hypot(winPos.x - spawnPos.x, winPos.y - spawnPos.y) < 150); // ensure goal is not too close
+
+    level.goal = Rect{winPos.x, winPos.y, GoalSize, GoalSize};
+
+    // Generate platforms from spawn to win position
+    level.platforms.reserve(NumPlatforms + 3);
+    const double stepY = (spawnPos.y - winPos.y) / NumPlatforms;
+    for (int i = 0; i < NumPlatforms; ++i) {
+        const double y = spawnPos.y - i * stepY;
+        double x;
+        do {
+            x = rng.bounded(bounds.w - PlatformWidth);
+        } while (std::abs(x - spawnPos.x) < 100 && std::abs(y - spawnPos.y) < 80);
+
+        level.platforms.push_back(Rect{x, y, PlatformWidth, PlatformHeight});
+
+        // 40% chance to spawn a red triangle (spike) on the platform
+        if (rng.bounded(0, 100) < SpikeChancePercent) {
+            const int spikeOffset = rng.bounded(10, 70);
+            level.spikes.push_back(Triangle{Vec2{x + spikeOffset + 10, y - SpikeHeight},
+                                            Vec2{x + spikeOffset, y},
+                                            Vec2{x + spikeOffset + SpikeWidth, y}});
+        }
+    }
+
+    // Add a few platforms near the goal to make landing easier
+    const int safePlatforms = rng.bounded(2, 4);
+    for (int i = 0; i < safePlatforms; ++i) {
+        double px = winPos.x + rng.bounded(-60, 60);
+        double py = winPos.y + 40 + rng.bounded(0, 40);
+        px = std::clamp(px, 0.0, bounds.w - PlatformWidth);
+        py = std::clamp(py, 0.0, bounds.h - PlatformHeight);
+        level.platforms.push_back(Rect{px, py, PlatformWidth, PlatformHeight});
+    }
+
+    return level;
+}
+
+LevelData generateLevelData(uint64_t runSeed, int levelIndex, const Rect& bounds, LevelGenerator generator) {
+    LevelData level = generateLayout(runSeed, levelIndex, bounds, generator);
+    addCheckpoints(level);
+    return level;
+}
@@ -0,0 +1,142 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+// The level module holds the plain data for one level (no Qt items) and the
+// seeded generator that builds it. Both the game window and the headless tools
+// build their levels from here, so a seed always produces the same layout.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-----------------------------------------
+// A 2D point / vector in scene pixels.
+struct Vec2 {
+    double x = 0;
+    double y = 0;
+};
+
+//-----------------------------------------
+// An axis-aligned rectangle, same meaning as QRectF (x/y is the top-left corner).
+struct Rect {
+    double x = 0;
+    double y = 0;
+    double w = 0;
+    double h = 0;
+
+    double left() const { return x; }
+    double top() const { return y; }
+    double right() const { return x + w; }
+    double bottom() const { return y + h; }
+
+    // Same rule as QRectF::intersects(): edges that only touch do not count
+    bool intersects(const Rect& o) const {
+        return x < o.right() && o.x < right() && y < o.bottom() && o.y < bottom();
+    }
+
+    // Grow the rectangle by m pixels on every side
+    Rect adjusted(double m) const { return Rect{x - m, y - m, w + 2 * m, h + 2 * m}; }
+};
+
+//-----------------------------------------
+// A spike. "apex" is the top point, "left"/"right" sit on the platform.
+struct Triangle {
+    Vec2 apex;
+    Vec2 left;
+    Vec2 right;
+};
+
+//-----------------------------------------
+// Sizes and numbers shared by the generator, the game window and the simulation.
+namespace LevelConfig {
+    // The game world is measured in world units, not screen pixels. The window
+    // scales it to whatever size it is (1 unit = 1 pixel at 1000x500).
+    constexpr double WorldWidth = 1000;
+    constexpr double WorldHeight = 500;
+
+    constexpr double PlayerSize = 20;        // Player square (rect is 20x20)
+    constexpr double PenHalfWidth = 0.5;     // Qt items are outlined with a 1px pen
+    constexpr double PlatformWidth = 80;
+    constexpr double PlatformHeight = 10;
+    constexpr double BasePlatformWidth = 100;
+    constexpr double GoalSize = 30;          // Diameter of the win circle
+    constexpr double SpikeWidth = 20;
+    constexpr double SpikeHeight = 10;
+    constexpr int NumPlatforms = 14;         // Platforms between spawn and goal
+    constexpr int SpikeChancePercent = 40;   // Chance of a spike on each platform
+    constexpr double CheckpointWidth = 10;   // The flag that stands on a checkpoint platform
+    constexpr double CheckpointHeight = 20;
+    constexpr double CheckpointSpacing = 200; // One checkpoint per this much distance from spawn to goal
+}
+
+// The standard world, what every run uses unless a replay says otherwise
+inline Rect worldBounds() {
+    return Rect{0, 0, LevelConfig::WorldWidth, LevelConfig::WorldHeight};
+}
+
+//-----------------------------------------
+// A small, fast random number generator (SplitMix64).
+// We use our own instead of QRandomGenerator::global() so that the same seed
+// always gives the same level on every machine.
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // A number in [0, highest), like QRandomGenerator::bounded(double)
+    double bounded(double highest) {
+        return (next() >> 11) * (1.0 / 9007199254740992.0) * highest;
+    }
+
+    // A whole number in [lowest, highest), like QRandomGenerator::bounded(int, int)
+    int bounded(int lowest, int highest) {
+        return lowest + int(next() % uint64_t(highest - lowest));
+    }
+
+private:
+    uint64_t state;
+};
+
+//-----------------------------------------
+// Everything needed to draw or simulate one level.
+struct LevelData {
+    Rect bounds;                     // The scene rectangle the level was made for
+    Vec2 spawn;                      // Where the player starts (and respawns)
+    Rect goal;                       // Bounding box of the yellow win circle
+    std::vector<Rect> platforms;     // Platforms the player can stand on
+    std::vector<Triangle> spikes;    // Spikes that kill the player
+    std::vector<float> terrain;      // Ground height per column (see terrain.h); empty = flat floor
+    std::vector<Rect> checkpoints;   // Flags that save the player's state when touched, in order from spawn to goal
+};
+
+//-----------------------------------------
+// The ways levels can be built. The number is stored in replays and results
+// files, so existing values must never change.
+enum class LevelGenerator : uint8_t {
+    Classic = 0,     // Random platforms on evenly spaced rows (the original game)
+    PathFirst = 1,   // A chain of jumps that is always reachable, then decoration
+    Chunks = 2,      // Hand-made chunks stitched together with precomputed tables
+    Hills = 3,       // PathFirst platforms over rolling terrain
+};
+constexpr uint8_t LevelGeneratorCount = 4;   // Keep in step with the enum
+
+// "classic", "path"... for command lines and reports
+const char* generatorName(LevelGenerator generator);
+bool parseGenerator(const std::string& name, LevelGenerator& generator);
+
+// Mix the run seed and level number into the seed for that one level
+uint64_t levelSeed(uint64_t runSeed, int levelIndex);
+
+// Build level number "levelIndex" of the run started with "runSeed".
+// Level 0 is always the fixed starting room, later levels are random.
+// Checkpoints are placed on the finished layout and use no random numbers,
+// so they never change the layout a seed gives.
+LevelData generateLevelData(uint64_t runSeed, int levelIndex, const Rect& bounds,
+                            LevelGenerator generator = LevelGenerator::Classic);
+
+#endif // LEVEL_H
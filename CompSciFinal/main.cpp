@@ -1,322 +1,199 @@
-// These are all the necessary Qt libraries we need to use graphics, keyboard input, timers, and more.
 #include <QApplication>             // Runs the Qt application
+#include <QCommandLineParser>       // Reads options like --seed from the command line
+#include <QDir>                     // Makes the folder for personal bests
 #include <QGraphicsScene>           // The "world" where all game objects live
-#include <QGraphicsView>            // The window/frame that shows part of the scene
-#include <QGraphicsRectItem>        // A rectangular game object (like our player or platforms)
-#include <QGraphicsEllipseItem>     // A circular object (like our win circle)
-#include <QGraphicsPolygonItem>     // Used for drawing triangle spikes
-#include <QKeyEvent>                // Handles key presses
-#include <QTimer>                   // Lets us run code repeatedly, like a game loop
-#include <QSet>                     // Stores keys being pressed
-#include <QDebug>                   // Useful for printing debug messages (not used here)
-#include <QGraphicsTextItem>        // Used to draw text (like lives and level count)
-#include <QRandomGenerator>         // Lets us create random numbers (used for procedural level generation)
-#include <QGraphicsSimpleTextItem>  // Not used but useful for simple text rendering
+#include <QRandomGenerator>         // Picks a random seed when none is given
+#include <QStandardPaths>           // Where personal bests are kept by default
+#include <QTimer>                   // Ticks the game while playing a replay
+
+#include <cmath>
+#include <memory>
+
+#include "crowdview.h"              // Crowd mode: thousands of bot runners
+#include "gameview.h"               // The game window and controller
+#include "metricsserver.h"          // Optional /metrics endpoint
+#include "multiplayer.h"            // Split-screen games for 2 to 4 players
+#include "soaktest.h"               // Long automated runs that look for leaks
+#include "startupprofile.h"         // Timing of each startup phase
+#include "metrics.h"                // Time to first frame is published as a metric
+#include "replay.h"                 // Replays played back with --play
 
 //-----------------------------------------
-// This class represents the player character.
-// It's just a blue square that the user controls.
-class Player : public QGraphicsRectItem {
-public:
-    Player() {
-        setRect(0, 0, 20, 20);   // Set width and height to 20x20 pixels
-        setBrush(Qt::blue);     // Fill the rectangle with blue color
-    }
-};
-
-//-----------------------------------------
-// GameView is the main window and game controller.
-// It handles drawing, physics, input, and level generation.
-class GameView : public QGraphicsView {
-    Q_OBJECT
-
-public:
-    GameView(QGraphicsScene* scene)
-        : QGraphicsView(scene), player(new Player()), winCircle(nullptr), deaths(0), level(0), verticalVelocity(0), gameOverText(nullptr) {
-
-        // Set the size of the game window
-        setFixedSize(1000, 500);
-
-        // Ensure the window can receive keyboard input
-        setFocusPolicy(Qt::StrongFocus);
-
-        // Remove scrollbars (we don't want to scroll around the scene)
-        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-
-        // Add player to the scene
-        scene->addItem(player);
-
-        // Create on-screen text for lives and level
-        livesText = new QGraphicsTextItem();
-        levelsText = new QGraphicsTextItem();
-        scene->addItem(livesText);
-        scene->addItem(levelsText);
-        livesText->setPos(10, 10);
-        levelsText->setPos(10, 30);
-
-        // Start the timer to update the game 60 times per second (1000ms / 16 ≈ 60fps)
-        moveTimer = new QTimer(this);
-        connect(moveTimer, &QTimer::timeout, this, &GameView::updatePosition);
-        moveTimer->start(16);
-
-        // Set the background to light blue
-        scene->setBackgroundBrush(QBrush(QColor(173, 216, 230)));
-
-        // Generate the first level
-        generateLevel();
-    }
-
-protected:
-    // Whenever a key is pressed, record it
-    void keyPressEvent(QKeyEvent* event) override {
-        keysPressed.insert(event->key());
-    }
-
-    // Whenever a key is released, stop tracking it
-    void keyReleaseEvent(QKeyEvent* event) override {
-        keysPressed.remove(event->key());
-    }
-
-    // Automatically resize the scene when the window resizes
-    void resizeEvent(QResizeEvent* event) override {
-        QRectF newRect(0, 0, viewport()->width(), viewport()->height());
-        scene()->setSceneRect(newRect);
-        QGraphicsView::resizeEvent(event);
+// The main function that runs the whole application
+int main(int argc, char *argv[]) {
+    QApplication app(argc, argv); // Create the Qt app
+    StartupProfile::mark("QApplication");
+
+    // Optional command line settings:
+    //   --seed N          play the run with this seed (same seed = same levels)
+    //   --record FILE     save every tick's input so the run can be replayed
+    //   --play FILE       watch a recorded (or route_search) run instead of playing
+    //   --generator NAME  how levels are built: classic (default), path, chunks or hills
+    //   --atlas FILE      draw with the art in this image (see spriteatlas.h)
+    //   --players N       split-screen game for N (2 to 4) players on one keyboard
+    //   --crowd N         watch N bot runners play the same level at once
+    //   --time-attack N   race through N levels against the timer and your personal best
+    //   --bests FILE      keep time attack personal bests in this file
+    //   --speed X         start at X times normal speed (0.25 to 16, + and - change it)
+    //   --metrics-port N  serve counters at http://127.0.0.1:N/metrics
+    //   --soak N          let a bot play N levels fast and check for leaks/slowdowns
+    //   --profile-startup print how long each startup phase took
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption seedOption("seed", "Seed for level generation.", "seed");
+    QCommandLineOption recordOption("record", "Save a replay of this run to <file>.", "file");
+    QCommandLineOption playOption("play", "Play back the replay in <file>.", "file");
+    QCommandLineOption generatorOption("generator", "Level generator: classic, path, chunks or hills.", "name", "classic");
+    QCommandLineOption atlasOption("atlas", "Draw with the sprites in the image <file>.", "file");
+    QCommandLineOption playersOption("players", "Split-screen game for <n> (2-4) players: WAD, arrows, JLI, numpad 468.", "n");
+    QCommandLineOption crowdOption("crowd", "Watch <n> bot runners play one level together.", "n");
+    QCommandLineOption timeAttackOption("time-attack", "Time attack over <levels> levels, with splits and personal bests.", "levels");
+    QCommandLineOption bestsOption("bests", "Keep time attack personal bests in <file>.", "file");
+    QCommandLineOption speedOption("speed", "Game speed: 0.25, 0.5, 1, 2, 4, 8 or 16 (+ and - keys change it).", "x", "1");
+    QCommandLineOption metricsOption("metrics-port", "Serve Prometheus metrics on localhost:<port>.", "port");
+    QCommandLineOption soakOption("soak", "Run a soak test of <levels> levels and exit.", "levels");
+    QCommandLineOption profileOption("profile-startup", "Print the time taken by each startup phase.");
+    parser.addOption(seedOption);
+    parser.addOption(recordOption);
+    parser.addOption(playOption);
+    parser.addOption(generatorOption);
+    parser.addOption(atlasOption);
+    parser.addOption(playersOption);
+    parser.addOption(crowdOption);
+    parser.addOption(timeAttackOption);
+    parser.addOption(bestsOption);
+    parser.addOption(speedOption);
+    parser.addOption(metricsOption);
+    parser.addOption(soakOption);
+    parser.addOption(profileOption);
+    parser.process(app);
+    StartupProfile::mark("command line");
+
+    quint64 seed = QRandomGenerator::global()->generate64();
+    if (parser.isSet(seedOption)) seed = parser.value(seedOption).toULongLong();
+
+    LevelGenerator generator = LevelGenerator::Classic;
+    if (!parseGenerator(parser.value(generatorOption).toStdString(), generator)) {
+        qWarning("Unknown level generator %s", qPrintable(parser.value(generatorOption)));
+        return 1;
     }
 
-private:
-    // Game elements
-    Player* player;
-    QGraphicsEllipseItem* winCircle;                // The yellow goal
-    QVector<QGraphicsPolygonItem*> redTriangles;    // Spikes that kill the player
-    QVector<QGraphicsRectItem*> platforms;          // Platforms the player stands on
-    QTimer* moveTimer;                              // The game loop
-    QSet<int> keysPressed;                          // Set of currently pressed keys
-    int verticalVelocity;                           // Used for jumping and falling
-    int deaths;                                     // Number of times the player hit a spike
-    int level;                                      // Number of levels completed
-    QGraphicsTextItem* livesText;                   // HUD text
-    QGraphicsTextItem* levelsText;
-    QPointF lastSpawnPos;                           // Where to respawn the player
-    QGraphicsTextItem* gameOverText;                // Text shown on game over
-
-    //-----------------------------------------
-    // This function builds or resets the level layout
-    void generateLevel() {
-        // Remove the previous win circle and delete it
-        if (winCircle) scene()->removeItem(winCircle);
-        delete winCircle;
-
-        // Remove all old spikes
-        for (auto tri : redTriangles) scene()->removeItem(tri);
-        redTriangles.clear();
-
-        // Remove all old platforms
-        for (auto plt : platforms) scene()->removeItem(plt);
-        platforms.clear();
-
-        // Remove the game over screen if it's still showing
-        if (gameOverText) {
-            scene()->removeItem(gameOverText);
-            delete gameOverText;
-            gameOverText = nullptr;
+    // Several players get their own window type; recording, replays and the
+    // soak test are single player only
+    if (parser.isSet(playersOption)) {
+        const int players = parser.value(playersOption).toInt();
+        if (players < MultiplayerConfig::MinPlayers || players > MultiplayerConfig::MaxPlayers) {
+            qWarning("--players must be between %d and %d", MultiplayerConfig::MinPlayers, MultiplayerConfig::MaxPlayers);
+            return 1;
         }
-
-        // Set the player starting point
-        QRectF sceneBounds = scene()->sceneRect();
-        QPointF spawnPos;
-
-        if (level == 0 || lastSpawnPos.isNull()) {
-            // First level: put the player in the middle bottom
-            spawnPos = QPointF(sceneBounds.width() / 2, sceneBounds.height() - player->rect().height());
-            lastSpawnPos = spawnPos;
-
-            // Create the goal near the bottom
-            winCircle = new QGraphicsEllipseItem(sceneBounds.width() / 2 - 100, sceneBounds.height() - 50, 30, 30);
-
-            // Create a platform directly under spawn
-            QGraphicsRectItem* basePlatform = new QGraphicsRectItem(spawnPos.x() - 40, spawnPos.y() + 20, 100, 10);
-            basePlatform->setBrush(Qt::darkGray);
-            scene()->addItem(basePlatform);
-            platforms.append(basePlatform);
-        } else {
-            // For new levels: generate a random goal position far from the player
-            spawnPos = lastSpawnPos;
-            QPointF winPos;
-
-            do {
-                winPos = QPointF(QRandomGenerator::global()->bounded(sceneBounds.width()),
-                                 QRandomGenerator::global()->bounded(sceneBounds.height() / 2));
-            } while (QLineF(spawnPos, winPos).length() < 150); // ensure goal is not too close
-
-            winCircle = new QGraphicsEllipseItem(winPos.x(), winPos.y(), 30, 30);
-
-            // Generate platforms from spawn to win position
-            int numPlatforms = 14;
-            qreal stepY = (spawnPos.y() - winPos.y()) / numPlatforms;
-            for (int i = 0; i < numPlatforms; ++i) {
-                qreal y = spawnPos.y() - i * stepY;
-                qreal x;
-                do {
-                    x = QRandomGenerator::global()->bounded(sceneBounds.width() - 80);
-                } while (qAbs(x - spawnPos.x()) < 100 && qAbs(y - spawnPos.y()) < 80);
-
-                QGraphicsRectItem* platform = new QGraphicsRectItem(x, y, 80, 10);
-                platform->setBrush(Qt::darkGray);
-                scene()->addItem(platform);
-                platforms.append(platform);
-
-                // 40% chance to spawn a red triangle (spike) on the platform
-                if (QRandomGenerator::global()->bounded(100) < 40) {
-                    int spikeOffset = QRandomGenerator::global()->bounded(10, 70);
-                    QPolygonF triangle;
-                    triangle << QPointF(x + spikeOffset + 10, y - 10)
-                             << QPointF(x + spikeOffset, y)
-                             << QPointF(x + spikeOffset + 20, y);
-                    QGraphicsPolygonItem* tri = new QGraphicsPolygonItem(triangle);
-                    tri->setBrush(Qt::red);
-                    scene()->addItem(tri);
-                    redTriangles.append(tri);
-                }
-            }
-
-            // Add a few platforms near the goal to make landing easier
-            int safePlatforms = QRandomGenerator::global()->bounded(2, 4);
-            for (int i = 0; i < safePlatforms; ++i) {
-                qreal px = winPos.x() + QRandomGenerator::global()->bounded(-60, 60);
-                qreal py = winPos.y() + 40 + QRandomGenerator::global()->bounded(0, 40);
-                px = qBound(0.0, px, sceneBounds.width() - 80);
-                py = qBound(0.0, py, sceneBounds.height() - 10);
-
-                QGraphicsRectItem* platform = new QGraphicsRectItem(px, py, 80, 10);
-                platform->setBrush(Qt::darkGray);
-                scene()->addItem(platform);
-                platforms.append(platform);
-            }
+        if (parser.isSet(recordOption) || parser.isSet(playOption) || parser.isSet(soakOption) || parser.isSet(crowdOption)) {
+            qWarning("--players can't be used with --record, --play, --soak or --crowd");
+            return 1;
         }
-
-        // Add the player and win circle to the scene
-        player->setPos(spawnPos);
-        scene()->addItem(winCircle);
-        winCircle->setBrush(Qt::yellow);
-
-        // Update the heads-up display text
-        updateHUD();
+        MultiplayerGame game(players, seed, generator);
+        if (parser.isSet(atlasOption) && !game.loadSpriteAtlas(parser.value(atlasOption)))
+            qWarning("Could not read sprite atlas %s, using the built-in one", qPrintable(parser.value(atlasOption)));
+        game.show();
+        return app.exec();
     }
 
-    //-----------------------------------------
-    // Updates the "Lives left" and "Levels won" text
-    void updateHUD() {
-        livesText->setPlainText(QString("Lives left: %1").arg(10 - deaths));
-        levelsText->setPlainText(QString("Levels won: %1").arg(level));
-    }
-
-    //-----------------------------------------
-    // Show a red "Game Over" message in the center
-    void showGameOver() {
-        gameOverText = new QGraphicsTextItem();
-        gameOverText->setPlainText(QString("Game Over!\nYou passed %1 levels.").arg(level));
-        QFont font;
-        font.setPointSize(24);
-        font.setBold(true);
-        gameOverText->setFont(font);
-        gameOverText->setDefaultTextColor(Qt::red);
-        gameOverText->setPos(scene()->width() / 2 - 150, scene()->height() / 2 - 50);
-        scene()->addItem(gameOverText);
-    }
-
-private slots:
-    //-----------------------------------------
-    // The main game loop, called ~60 times per second
-    void updatePosition() {
-        // Stop the game if the player has died too many times
-        if (deaths >= 10) {
-            if (!gameOverText) {
-                showGameOver();
-            }
-            return;
+    // So does crowd mode, which is only watched
+    if (parser.isSet(crowdOption)) {
+        const int runners = parser.value(crowdOption).toInt();
+        if (runners < 1) {
+            qWarning("--crowd needs at least 1 runner");
+            return 1;
         }
-
-        // Store the player's current position and size
-        QPointF currentPos = player->pos();
-        QRectF sceneBounds = scene()->sceneRect();
-        QRectF playerRect = player->boundingRect();
-
-        // Move left and right
-        if (keysPressed.contains(Qt::Key_D)) currentPos.setX(currentPos.x() + 7);
-        if (keysPressed.contains(Qt::Key_A)) currentPos.setX(currentPos.x() - 7);
-
-        // Simulate gravity by reducing upward velocity
-        verticalVelocity -= 1;
-        QPointF nextPos = currentPos;
-        nextPos.setY(currentPos.y() - verticalVelocity); // Y is inverted in Qt
-
-        bool onGround = false;
-
-        // Check for collision with any platform
-        for (auto* platform : platforms) {
-            QRectF platRect = platform->sceneBoundingRect();
-            QRectF playerNextRect(nextPos, playerRect.size());
-
-            // Only land if falling down and above the platform
-            if (playerNextRect.intersects(platRect) && verticalVelocity <= 0 &&
-                currentPos.y() + playerRect.height() <= platRect.top()) {
-                nextPos.setY(platRect.top() - playerRect.height());
-                verticalVelocity = 0;
-                onGround = true;
-                break;
-            }
-        }
-
-        // Stop the fall if player hits the bottom of the scene
-        if (nextPos.y() >= sceneBounds.bottom() - playerRect.height()) {
-            nextPos.setY(sceneBounds.bottom() - playerRect.height());
-            onGround = true;
-            verticalVelocity = 0;
+        if (parser.isSet(recordOption) || parser.isSet(playOption) || parser.isSet(soakOption)) {
+            qWarning("--crowd can't be used with --record, --play or --soak");
+            return 1;
         }
+        CrowdView view(runners, seed, generator);
+        if (parser.isSet(atlasOption) && !view.loadSpriteAtlas(parser.value(atlasOption)))
+            qWarning("Could not read sprite atlas %s, using the built-in one", qPrintable(parser.value(atlasOption)));
+        view.show();
+        return app.exec();
+    }
 
-        // Jump when pressing W while on ground
-        if (keysPressed.contains(Qt::Key_W) && onGround) {
-            verticalVelocity = 20;
+    // A replay brings its own seed, scene size and generator
+    Replay replay;
+    if (parser.isSet(playOption)) {
+        if (!loadReplay(parser.value(playOption).toStdString(), replay)) {
+            qWarning("Could not read replay %s", qPrintable(parser.value(playOption)));
+            return 1;
         }
+        seed = replay.seed;
+        generator = replay.generator;
+    }
 
-        // Prevent the player from leaving screen horizontally
-        nextPos.setX(qBound(sceneBounds.left(), nextPos.x(), sceneBounds.right() - playerRect.width()));
-        player->setPos(nextPos);
-
-        // Check for winning
-        if (player->collidesWithItem(winCircle)) {
-            level++;
-            generateLevel();
+    QGraphicsScene scene;
+    if (parser.isSet(playOption)) scene.setSceneRect(0, 0, replay.width, replay.height);
+    else scene.setSceneRect(0, 0, LevelConfig::WorldWidth, LevelConfig::WorldHeight); // Set game world size
+
+    GameView view(&scene, seed, parser.value(recordOption), generator); // Create and show the game
+    if (parser.isSet(atlasOption) && !view.loadSpriteAtlas(parser.value(atlasOption)))
+        qWarning("Could not read sprite atlas %s, using the built-in one", qPrintable(parser.value(atlasOption)));
+
+    // Times come from the ticks, so a replay played with --time-attack shows the same splits
+    if (parser.isSet(timeAttackOption)) {
+        const int levels = parser.value(timeAttackOption).toInt();
+        if (levels < 1) {
+            qWarning("--time-attack needs at least 1 level");
+            return 1;
         }
-
-        // Check for hitting a spike
-        for (auto* tri : redTriangles) {
-            if (player->collidesWithItem(tri)) {
-                deaths++;
-                player->setPos(lastSpawnPos);
-                break;
-            }
+        QString bestsPath = parser.value(bestsOption);
+        if (bestsPath.isEmpty()) {
+            const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+            QDir().mkpath(dir);
+            bestsPath = QDir(dir).filePath("personal_bests.csfp");
         }
-
-        // Update UI text
-        updateHUD();
+        view.setTimeAttack(levels, bestsPath);
     }
-};
 
-//-----------------------------------------
-// The main function that runs the whole application
-int main(int argc, char *argv[]) {
-    QApplication app(argc, argv); // Create the Qt app
-
-    QGraphicsScene scene;
-    scene.setSceneRect(0, 0, 1000, 500); // Set game world size
-
-    GameView view(&scene); // Create and show the game
+    // Speeds are powers of two, so every frame runs a whole number of ticks (or one every few frames)
+    const double speed = parser.value(speedOption).toDouble();
+    const int speedPower = int(std::lround(std::log2(speed > 0 ? speed : 1)));
+    if (speedPower < GameSpeed::Slowest || speedPower > GameSpeed::Fastest || std::ldexp(1.0, speedPower) != speed) {
+        qWarning("--speed must be 0.25, 0.5, 1, 2, 4, 8 or 16");
+        return 1;
+    }
+    view.setSpeed(speedPower);
+    StartupProfile::mark("game view + first level");
     view.show();
+    StartupProfile::mark("show()");
+
+    // Anything the first frame doesn't need waits until it is on screen
+    std::unique_ptr<MetricsServer> metricsServer;
+    std::unique_ptr<SoakTest> soak;
+    QTimer playTimer;
+    size_t playPos = 0;
+    QObject::connect(&view, &GameView::firstFrameShown, &app, [&]() {
+        StartupProfile::mark("first frame");
+        gameMetrics().timeToFirstFrameNs.store(StartupProfile::elapsedNs(), std::memory_order_relaxed);
+        if (parser.isSet(profileOption)) StartupProfile::report();
+
+        if (parser.isSet(metricsOption)) metricsServer.reset(new MetricsServer(parser.value(metricsOption).toUShort()));
+
+        // In soak mode the bot takes over and the exit code says whether it passed
+        if (parser.isSet(soakOption)) {
+            SoakConfig soakConfig;
+            soakConfig.levels = qMax(1, parser.value(soakOption).toInt());
+            soak.reset(new SoakTest(&view, seed, soakConfig));
+            QObject::connect(soak.get(), &SoakTest::finished, &app, [&app](bool passed) { app.exit(passed ? 0 : 1); });
+            soak->start();
+        }
+
+        // Playback: the replay's inputs are fed to the game, as many ticks per frame as the speed asks
+        if (parser.isSet(playOption)) {
+            view.takeControl([&]() { return playPos < replay.inputs.size() ? replay.inputs[playPos++] : quint8(0); });
+            QObject::connect(&playTimer, &QTimer::timeout, &view, [&]() {
+                const size_t left = replay.inputs.size() - playPos;
+                if (left > 0) view.advance(int(qMin<size_t>(size_t(view.takeFrameTicks()), left)));
+                else playTimer.stop();
+            });
+            playTimer.start(SimConfig::TickMs);
+        }
+    });
 
     return app.exec(); // Start the event loop
 }
-
-#include "main.moc" // Required if using Q_OBJECT in the same file
@@ -0,0 +1,97 @@
+#include "metrics.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+//-----------------------------------------
+void DurationHistogram::observe(int64_t nanoseconds) {
+    int bucket = 0;
+    while (nanoseconds > BucketBoundsNs[bucket]) ++bucket;   // The last bound is INT64_MAX, so this stops
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(uint64_t(nanoseconds > 0 ? nanoseconds : 0), std::memory_order_relaxed);
+}
+
+void DurationHistogram::writeText(std::string& out, const char* name, const char* help) const {
+    char line[160];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    out += line;
+
+    // Prometheus buckets are cumulative: each one counts everything up to its bound
+    uint64_t cumulative = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        if (i + 1 < BucketCount)
+            std::snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", name, BucketBoundsNs[i] / 1e9,
+                          (unsigned long long)cumulative);
+        else
+            std::snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)cumulative);
+        out += line;
+    }
+    std::snprintf(line, sizeof(line), "%s_sum %.9f\n%s_count %llu\n", name,
+                  sumNs.load(std::memory_order_relaxed) / 1e9, name, (unsigned long long)count.load(std::memory_order_relaxed));
+    out += line;
+}
+
+//-----------------------------------------
+// Small helper for one counter or gauge line with its HELP and TYPE
+static void writeValue(std::string& out, const char* name, const char* type, const char* help, double value) {
+    char line[200];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n", name, help, name, type, name, value);
+    out += line;
+}
+
+std::string GameMetrics::prometheusText() const {
+    std::string out;
+    out.reserve(2048);
+    writeValue(out, "csf_ticks_total", "counter", "Game loop ticks run.", double(ticks.load(std::memory_order_relaxed)));
+    tickDuration.writeText(out, "csf_tick_duration_seconds", "Time spent in one game loop tick.");
+    writeValue(out, "csf_levels_generated_total", "counter", "Levels generated.",
+               double(levelsGenerated.load(std::memory_order_relaxed)));
+    generationDuration.writeText(out, "csf_level_generation_seconds", "Time spent generating one level.");
+    writeValue(out, "csf_deaths_total", "counter", "Spike deaths.", double(deaths.load(std::memory_order_relaxed)));
+    writeValue(out, "csf_scene_items", "gauge", "Items currently in the game scene.",
+               double(sceneItems.load(std::memory_order_relaxed)));
+    writeValue(out, "csf_time_to_first_frame_seconds", "gauge", "Time from program start to the first frame.",
+               timeToFirstFrameNs.load(std::memory_order_relaxed) / 1e9);
+    writeValue(out, "csf_resident_memory_bytes", "gauge", "Resident set size of the process.", double(residentMemoryBytes()));
+    return out;
+}
+
+GameMetrics& gameMetrics() {
+    static GameMetrics metrics;
+    return metrics;
+}
+
+//-----------------------------------------
+// Each platform has its own way of asking for the process's memory use
+uint64_t residentMemoryBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.WorkingSetSize;
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t size = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, task_info_t(&info), &size) == KERN_SUCCESS) return info.resident_size;
+    return 0;
+#elif defined(__linux__)
+    // The second number in /proc/self/statm is resident pages
+    unsigned long long pages = 0, resident = 0;
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    const int read = std::fscanf(statm, "%llu %llu", &pages, &resident);
+    std::fclose(statm);
+    return read == 2 ? resident * uint64_t(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
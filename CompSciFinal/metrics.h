@@ -0,0 +1,53 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// Runtime counters for the game and headless hosts.
+// Everything is a lock-free atomic: the game loop only does relaxed adds and
+// stores, and a reader (the metrics endpoint) can look at any time without
+// ever making the game wait.
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+//-----------------------------------------
+// A Prometheus-style histogram of durations with fixed buckets.
+class DurationHistogram {
+public:
+    static constexpr int BucketCount = 10;
+    // Upper bound of each bucket in nanoseconds (the last one catches everything)
+    static constexpr int64_t BucketBoundsNs[BucketCount] = {
+        50'000, 100'000, 250'000, 500'000, 1'000'000, 2'500'000, 5'000'000, 10'000'000, 16'000'000, INT64_MAX};
+
+    void observe(int64_t nanoseconds);
+
+    // Append this histogram to a Prometheus text page
+    void writeText(std::string& out, const char* name, const char* help) const;
+
+private:
+    std::atomic<uint64_t> buckets[BucketCount] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumNs{0};
+};
+
+//-----------------------------------------
+// All counters for one process.
+struct GameMetrics {
+    std::atomic<uint64_t> ticks{0};              // Game loop ticks run
+    std::atomic<uint64_t> levelsGenerated{0};    // Levels built
+    std::atomic<uint64_t> deaths{0};             // Spike deaths
+    std::atomic<int64_t> sceneItems{0};          // Items in the scene right now
+    std::atomic<int64_t> timeToFirstFrameNs{0};  // Program start to first frame on screen
+    DurationHistogram tickDuration;              // Time spent in each tick
+    DurationHistogram generationDuration;        // Time spent building each level
+
+    // The whole page in Prometheus text format (RSS is read when this is called)
+    std::string prometheusText() const;
+};
+
+// The one set of counters for this process
+GameMetrics& gameMetrics();
+
+// Resident memory of this process in bytes (0 if the platform can't tell us)
+uint64_t residentMemoryBytes();
+
+#endif // METRICS_H
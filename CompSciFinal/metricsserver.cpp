@@ -0,0 +1,67 @@
+#include "metricsserver.h"
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "metrics.h"
+
+//-----------------------------------------
+// Build the reply for one request line like "GET /metrics HTTP/1.1".
+// Only counters and current values are sent, nothing that depends on when the
+// last scrape was: the tick rate is rate(csf_ticks_total[1m]) in Prometheus,
+// so any number of scrapers can poll without changing each other's numbers.
+static QByteArray buildResponse(const QByteArray& requestLine) {
+    const QList<QByteArray> parts = requestLine.split(' ');
+    const QByteArray path = parts.size() >= 2 ? parts[1] : QByteArray();
+    if (parts.value(0) != "GET" || (path != "/metrics" && path != "/")) {
+        return "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+
+    const std::string text = gameMetrics().prometheusText();
+
+    QByteArray response = "HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                          "Connection: close\r\n"
+                          "Content-Length: ";
+    response += QByteArray::number(qint64(text.size()));
+    response += "\r\n\r\n";
+    response += QByteArray::fromStdString(text);
+    return response;
+}
+
+//-----------------------------------------
+MetricsServer::MetricsServer(quint16 port) : server(new QTcpServer) {
+    // The server and its sockets live on our own thread with its own event loop
+    server->moveToThread(&thread);
+    QObject::connect(&thread, &QThread::finished, server, &QObject::deleteLater);
+
+    QTcpServer* srv = server;
+
+    QObject::connect(srv, &QTcpServer::newConnection, srv, [srv]() {
+        while (QTcpSocket* socket = srv->nextPendingConnection()) {
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+                // Wait until the whole request header has arrived
+                if (!socket->peek(8192).contains("\r\n\r\n")) return;
+                const QByteArray request = socket->readAll();
+                socket->write(buildResponse(request.left(request.indexOf("\r\n"))));
+                socket->disconnectFromHost();
+            });
+        }
+    });
+
+    QObject::connect(&thread, &QThread::started, srv, [srv, port]() {
+        if (!srv->listen(QHostAddress::LocalHost, port))
+            qWarning() << "Metrics server could not listen on port" << port << ":" << srv->errorString();
+    });
+
+    thread.setObjectName("metrics");
+    thread.start();
+}
+
+MetricsServer::~MetricsServer() {
+    thread.quit();
+    thread.wait();
+}
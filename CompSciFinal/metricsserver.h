@@ -0,0 +1,24 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+// A tiny HTTP server on localhost that answers GET /metrics with the
+// gameMetrics() counters in Prometheus text format. It runs on its own
+// thread, so a scrape never holds up the game loop.
+#include <QThread>
+
+class QTcpServer;
+
+class MetricsServer {
+public:
+    // Start listening on 127.0.0.1:<port>
+    explicit MetricsServer(quint16 port);
+
+    // Stop the server thread
+    ~MetricsServer();
+
+private:
+    QThread thread;
+    QTcpServer* server;
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,91 @@
+#include "minimap.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QRegion>
+
+#include "thumbnail.h"
+
+using namespace MinimapConfig;
+
+//-----------------------------------------
+Minimap::Minimap(QWidget* parent) : QWidget(parent) {
+    // Only a picture on top of the game: the keys and clicks go to the game
+    setFocusPolicy(Qt::NoFocus);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+
+    // paintEvent() covers every pixel, so Qt doesn't have to clear first
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void Minimap::setLevel(const LevelData& newLevel) {
+    level = &newLevel;
+
+    // The same shape as the level, Width pixels wide
+    const QSize size(Width, qMax(1, qRound(Width * level->bounds.h / level->bounds.w)));
+    if (this->size() != size) resize(size);   // resizeEvent() draws the picture
+    else drawPicture();
+    update();
+}
+
+void Minimap::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    drawPicture();
+}
+
+// The only time the level itself is drawn
+void Minimap::drawPicture() {
+    if (!level) return;
+
+    // At the screen's real pixel size, so it stays sharp on HiDPI screens
+    const qreal ratio = devicePixelRatioF();
+    QImage image(qMax(1, qRound(width() * ratio)), qMax(1, qRound(height() * ratio)), QImage::Format_ARGB32);
+    rasterizeThumbnail(*level, reinterpret_cast<uint32_t*>(image.bits()), image.width(), image.height(),
+                       int(image.bytesPerLine() / 4));
+    image.setDevicePixelRatio(ratio);
+    picture = QPixmap::fromImage(image);
+}
+
+//-----------------------------------------
+QRect Minimap::markerRect(const MinimapMarker& marker) const {
+    if (!level) return QRect();
+    const double scaleX = width() / level->bounds.w;
+    const double scaleY = height() / level->bounds.h;
+    const QPointF centre((marker.pos.x() + LevelConfig::PlayerSize / 2) * scaleX,
+                         (marker.pos.y() + LevelConfig::PlayerSize / 2) * scaleY);
+    return QRect(qRound(centre.x()) - MarkerSize / 2, qRound(centre.y()) - MarkerSize / 2, MarkerSize, MarkerSize);
+}
+
+// Repaint only where a marker was and where it is now
+void Minimap::setMarkers(const QVector<MinimapMarker>& newMarkers) {
+    QRegion dirty;
+    for (const MinimapMarker& m : markers) dirty += markerRect(m).adjusted(-1, -1, 1, 1);
+    markers = newMarkers;
+    for (const MinimapMarker& m : markers) dirty += markerRect(m).adjusted(-1, -1, 1, 1);
+    update(dirty);
+}
+
+void Minimap::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+
+    // The cached level, only the part that needs repainting
+    const QRect area = event->rect();
+    const qreal ratio = picture.devicePixelRatio();
+    painter.drawPixmap(area, picture, QRectF(area.x() * ratio, area.y() * ratio, area.width() * ratio, area.height() * ratio));
+
+    // The players, outlined so white and yellow markers still show
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(QPen(Qt::black, 1));
+    for (const MinimapMarker& m : markers) {
+        const QRect r = markerRect(m);
+        if (!r.intersects(area)) continue;
+        painter.setBrush(m.color);
+        painter.drawEllipse(QRectF(r).adjusted(0.5, 0.5, -0.5, -0.5));
+    }
+
+    // A frame, so the map stands apart from the game behind it (clipped to "area" like the rest)
+    painter.setRenderHint(QPainter::Antialiasing, false);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+}
@@ -0,0 +1,55 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+// A small map of the whole level in a corner of the window, for games where
+// the views follow the players and only show part of the level.
+//
+// The level (terrain, platforms, spikes, checkpoints and the goal) is drawn
+// once into a picture with rasterizeThumbnail() when the level is made, and
+// again only if the minimap changes size. Each frame only the player markers
+// move, and only the few pixels around the old and new markers are repainted.
+#include <QColor>
+#include <QPixmap>
+#include <QPointF>
+#include <QVector>
+#include <QWidget>
+
+#include "level.h"
+
+namespace MinimapConfig {
+    constexpr int Width = 200;        // Pixels; the height follows the level's shape
+    constexpr int MarkerSize = 6;     // A player is a dot this wide, whatever the scale
+}
+
+// One player on the map
+struct MinimapMarker {
+    QPointF pos;     // Top-left of the player, in scene units
+    QColor color;
+};
+
+//-----------------------------------------
+class Minimap : public QWidget {
+public:
+    explicit Minimap(QWidget* parent = nullptr);
+
+    // Draw the level's picture. "level" must stay alive until the next setLevel()
+    // (it is only read again if the minimap is resized).
+    void setLevel(const LevelData& level);
+
+    // Where the players are now
+    void setMarkers(const QVector<MinimapMarker>& markers);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    const LevelData* level = nullptr;
+    QPixmap picture;                  // The level, at the widget's size in device pixels
+    QVector<MinimapMarker> markers;
+
+    void drawPicture();
+    QRect markerRect(const MinimapMarker& marker) const;
+};
+
+#endif // MINIMAP_H
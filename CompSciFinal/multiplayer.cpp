@@ -0,0 +1,238 @@
+#include "multiplayer.h"
+
+#include <QFont>
+#include <QGridLayout>
+
+#include "parallax.h"
+
+using namespace MultiplayerConfig;
+
+//-----------------------------------------
+// The keys of each player. Player 4 uses the number pad.
+struct PlayerKeys {
+    int left;
+    int right;
+    int jump;
+};
+
+static const PlayerKeys KeyMaps[MaxPlayers] = {
+    {Qt::Key_A, Qt::Key_D, Qt::Key_W},
+    {Qt::Key_Left, Qt::Key_Right, Qt::Key_Up},
+    {Qt::Key_J, Qt::Key_L, Qt::Key_I},
+    {Qt::Key_4, Qt::Key_6, Qt::Key_8},
+};
+
+static const QColor PlayerColors[MaxPlayers] = {
+    QColor(255, 255, 255), QColor(255, 140, 0), QColor(50, 205, 50), QColor(255, 0, 255),
+};
+
+//-----------------------------------------
+PlayerView::PlayerView(QGraphicsScene* scene, const MultiplayerGame* game, int index)
+    : QGraphicsView(scene), game(game), index(index) {
+    // The window takes the keys for every player, so the views never get focus
+    setFocusPolicy(Qt::NoFocus);
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    // No transform: one world unit per pixel, like the single player window at
+    // its starting size. Each view shows the part of the level around its player.
+}
+
+void PlayerView::drawBackground(QPainter* painter, const QRectF& rect) {
+    const QRectF camera = mapToScene(viewport()->rect()).boundingRect();
+    ParallaxBackground::builtIn().draw(*painter, rect, camera, game->tick());
+}
+
+void PlayerView::drawForeground(QPainter* painter, const QRectF&) {
+    // The HUD is drawn in window pixels, so it stays put while the view follows the player
+    painter->save();
+    painter->resetTransform();
+
+    const SimState& state = game->playerState(index);
+    const int lives = qMax(0, SimConfig::MaxDeaths - state.deaths);
+    painter->setPen(game->playerColor(index).darker(150));
+    painter->drawText(QPointF(10, 20), QString("Player %1   Lives left: %2").arg(index + 1).arg(lives));
+    painter->setPen(Qt::black);
+    painter->drawText(QPointF(10, 40), QString("Levels won: %1").arg(game->levelsWon()));
+
+    if (lives == 0) {
+        QFont font;
+        font.setPointSize(game->gameOver() ? 24 : 16);
+        font.setBold(true);
+        painter->setFont(font);
+        painter->setPen(Qt::red);
+        painter->drawText(viewport()->rect(), Qt::AlignCenter,
+                          game->gameOver() ? QString("Game Over!\nYou passed %1 levels.").arg(game->levelsWon())
+                                           : QString("Out of lives"));
+    }
+    painter->restore();
+}
+
+//-----------------------------------------
+MultiplayerGame::MultiplayerGame(int playerCount, quint64 seed, LevelGenerator generator, QWidget* parent)
+    : QWidget(parent), levelItem(nullptr), runSeed(seed), levelGenerator(generator), level(0), ticks(0) {
+    const int count = qBound(MinPlayers, playerCount, MaxPlayers);
+
+    scene = new QGraphicsScene(this);
+    scene->setSceneRect(0, 0, LevelConfig::WorldWidth, LevelConfig::WorldHeight);
+
+    // Two players side by side, three or four in a 2x2 grid
+    QGridLayout* layout = new QGridLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(2);
+    const int columns = 2;
+    for (int i = 0; i < count; ++i) {
+        Seat seat;
+        seat.item = new Player(&atlas);
+        seat.item->setTint(PlayerColors[i]);
+        scene->addItem(seat.item);
+        seat.view = new PlayerView(scene, this, i);
+        layout->addWidget(seat.view, i / columns, i % columns);
+        seats.push_back(seat);
+    }
+
+    // Not in the layout: it sits on top of the views (see resizeEvent())
+    minimap = new Minimap(this);
+    minimap->raise();
+
+    setFocusPolicy(Qt::StrongFocus);
+    resize(int(LevelConfig::WorldWidth), int(LevelConfig::WorldHeight));
+
+    timer = new QTimer(this);
+    timer->setInterval(SimConfig::TickMs);
+    connect(timer, &QTimer::timeout, this, &MultiplayerGame::updateGame);
+
+    generateLevel();
+}
+
+QColor MultiplayerGame::playerColor(int index) const {
+    return PlayerColors[index];
+}
+
+bool MultiplayerGame::loadSpriteAtlas(const QString& path) {
+    if (!atlas.load(path)) return false;
+    scene->update();
+    return true;
+}
+
+bool MultiplayerGame::gameOver() const {
+    for (const Seat& seat : seats)
+        if (seat.state.deaths < SimConfig::MaxDeaths) return false;
+    return true;
+}
+
+void MultiplayerGame::keyPressEvent(QKeyEvent* event) {
+    keysPressed.insert(event->key());
+}
+
+void MultiplayerGame::keyReleaseEvent(QKeyEvent* event) {
+    keysPressed.remove(event->key());
+}
+
+// The game starts once the window is up
+void MultiplayerGame::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    if (!timer->isActive() && !gameOver()) timer->start();
+}
+
+// Keep the minimap at the bottom centre, clear of the HUDs at the top of each view
+void MultiplayerGame::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    minimap->move((width() - minimap->width()) / 2, height() - minimap->height() - 10);
+}
+
+quint8 MultiplayerGame::inputFor(int index) const {
+    const PlayerKeys& keys = KeyMaps[index];
+    quint8 input = 0;
+    if (keysPressed.contains(keys.left)) input |= InputLeft;
+    if (keysPressed.contains(keys.right)) input |= InputRight;
+    if (keysPressed.contains(keys.jump)) input |= InputJump;
+    return input;
+}
+
+//-----------------------------------------
+// Build the shared level and put everyone who still has lives at its start
+void MultiplayerGame::generateLevel() {
+    if (levelItem) scene->removeItem(levelItem);
+    delete levelItem;
+
+    levelData = generateLevelData(runSeed, level, worldBounds(), levelGenerator);
+    contacts.build(levelData);
+    levelItem = new LevelItem(levelData, &atlas);
+    scene->addItem(levelItem);
+
+    // The minimap's picture of the level is drawn now, not every frame
+    minimap->setLevel(levelData);
+
+    for (Seat& seat : seats) {
+        seat.state.checkpoint = Checkpoint{};
+        respawn(seat);
+    }
+}
+
+// Back to the player's own last checkpoint, or to the start. respawnPlayer()
+// decides what happens to the velocity, the same as in GameView and Simulation.
+void MultiplayerGame::respawn(Seat& seat) {
+    respawnPlayer(seat.state, levelData.spawn);
+    seat.contacts.clear();
+    seat.item->setPos(seat.state.x, seat.state.y);
+    seat.view->centerOn(seat.item);
+}
+
+//-----------------------------------------
+// The game loop: the same rules as GameView::updatePosition(), for every player
+void MultiplayerGame::updateGame() {
+    if (gameOver()) {
+        timer->stop();
+        for (Seat& seat : seats) seat.view->viewport()->update();
+        return;
+    }
+    ++ticks;
+
+    // Move everyone who is still playing
+    for (size_t i = 0; i < seats.size(); ++i) {
+        Seat& seat = seats[i];
+        if (seat.state.deaths >= SimConfig::MaxDeaths) continue;
+        ++seat.state.tick;
+        movePlayer(levelData, levelData.bounds, seat.state, inputFor(int(i)));
+    }
+
+    // Then what they touched. The first one to reach the goal takes everybody
+    // to the next level; a spike only sends its player back to their checkpoint.
+    bool won = false;
+    for (Seat& seat : seats) {
+        if (seat.state.deaths >= SimConfig::MaxDeaths) continue;
+        contacts.update(seat.state.x, seat.state.y, seat.contacts, contactEvents);
+        if (contactEntered(contactEvents, ContactGoal)) {
+            won = true;
+            break;
+        }
+        if (contactEntered(contactEvents, ContactSpike)) {
+            seat.state.deaths++;
+            respawn(seat);
+        } else {
+            saveCheckpoint(seat.state, contactEvents);
+        }
+    }
+    if (won) {
+        level++;
+        generateLevel();
+    }
+
+    // Show the new positions, with each view following its player
+    QVector<MinimapMarker> markers;
+    for (int i = 0; i < int(seats.size()); ++i) {
+        Seat& seat = seats[size_t(i)];
+        const bool playing = seat.state.deaths < SimConfig::MaxDeaths;
+        seat.item->setVisible(playing);
+        seat.item->setPos(seat.state.x, seat.state.y);
+        if (playing) {
+            seat.view->centerOn(seat.item);
+            markers.append(MinimapMarker{QPointF(seat.state.x, seat.state.y), PlayerColors[i]});
+        }
+        seat.view->viewport()->update();
+    }
+    minimap->setMarkers(markers);
+}
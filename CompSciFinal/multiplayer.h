@@ -0,0 +1,104 @@
+#ifndef MULTIPLAYER_H
+#define MULTIPLAYER_H
+
+// Split-screen local multiplayer: 2 to 4 players on one keyboard, each with
+// their own view that follows them. There is one level for everyone: one
+// LevelData, one contact grid and one scene with a single LevelItem, which every
+// view draws from its cached pictures. A new player only adds a Player item,
+// a few numbers of state and a view.
+//
+// Reaching the goal takes everyone to the next level. Each player has their
+// own lives; the game is over when everyone has run out. A minimap at the
+// bottom shows the whole level and where everybody is.
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QKeyEvent>
+#include <QSet>
+#include <QTimer>
+#include <QWidget>
+
+#include <vector>
+
+#include "contacts.h"
+#include "gameview.h"               // Player and LevelItem
+#include "minimap.h"
+#include "simulation.h"
+
+class MultiplayerGame;
+
+namespace MultiplayerConfig {
+    constexpr int MinPlayers = 2;
+    constexpr int MaxPlayers = 4;
+}
+
+//-----------------------------------------
+// One player's half (or quarter) of the window
+class PlayerView : public QGraphicsView {
+public:
+    PlayerView(QGraphicsScene* scene, const MultiplayerGame* game, int index);
+
+protected:
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void drawForeground(QPainter* painter, const QRectF& rect) override;   // The HUD
+
+private:
+    const MultiplayerGame* game;
+    int index;
+};
+
+//-----------------------------------------
+class MultiplayerGame : public QWidget {
+    Q_OBJECT
+
+public:
+    MultiplayerGame(int playerCount, quint64 seed, LevelGenerator generator, QWidget* parent = nullptr);
+
+    bool loadSpriteAtlas(const QString& path);
+
+    // What the views show
+    int playerCount() const { return int(seats.size()); }
+    const SimState& playerState(int index) const { return seats[size_t(index)].state; }
+    QColor playerColor(int index) const;
+    int levelsWon() const { return level; }
+    quint32 tick() const { return ticks; }
+    bool gameOver() const;
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+    void keyReleaseEvent(QKeyEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    // Everything that belongs to one player
+    struct Seat {
+        Player* item;
+        PlayerView* view;
+        SimState state;          // Position, velocity and deaths (level is shared, below)
+        ContactSet contacts;     // What this player touches in the shared contact grid
+    };
+
+    QGraphicsScene* scene;
+    SpriteAtlas atlas;
+    LevelData levelData;                      // The one level everybody plays
+    ContactTracker contacts;                  // The one contact grid, shared by all players
+    std::vector<ContactEvent> contactEvents;
+    LevelItem* levelItem;
+    Minimap* minimap;                         // Over the views, bottom centre
+    std::vector<Seat> seats;
+    QSet<int> keysPressed;
+    QTimer* timer;
+    quint64 runSeed;
+    LevelGenerator levelGenerator;
+    int level;
+    quint32 ticks;
+
+    void generateLevel();
+    void respawn(Seat& seat);
+    quint8 inputFor(int index) const;
+
+private slots:
+    void updateGame();
+};
+
+#endif // MULTIPLAYER_H
@@ -0,0 +1,161 @@
+#include "neuralbot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "binaryio.h"
+#include "terrain.h"
+
+using namespace NeuralConfig;
+
+//-----------------------------------------
+// File layout (all numbers little-endian):
+//   "CSFN"  magic
+//   u32     version
+//   u32     inputs, u32 hidden, u32 outputs (must match NeuralConfig)
+//   f32     every weight, in the order described in neuralbot.h
+static const char GenomeMagic[4] = {'C', 'S', 'F', 'N'};
+static const uint32_t GenomeVersion = 1;
+
+bool saveGenome(const std::string& path, const Genome& genome) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    out.write(GenomeMagic, 4);
+    writeLE(out, GenomeVersion);
+    writeLE(out, uint32_t(Inputs));
+    writeLE(out, uint32_t(Hidden));
+    writeLE(out, uint32_t(Outputs));
+    for (float w : genome.weights) writeLE(out, w);
+    return bool(out);
+}
+
+bool loadGenome(const std::string& path, Genome& genome) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint32_t version = 0, inputs = 0, hidden = 0, outputs = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, GenomeMagic, 4) != 0) return false;
+    if (!readLE(in, version) || version != GenomeVersion) return false;
+    if (!readLE(in, inputs) || !readLE(in, hidden) || !readLE(in, outputs)) return false;
+    if (inputs != uint32_t(Inputs) || hidden != uint32_t(Hidden) || outputs != uint32_t(Outputs)) return false;
+
+    genome.weights.assign(WeightCount, 0.0f);
+    for (float& w : genome.weights)
+        if (!readLE(in, w)) return false;
+    return true;
+}
+
+//-----------------------------------------
+// Mark every grid cell the rectangle covers with "value".
+// The grid is centred on the player.
+static void markCells(float* grid, double gridLeft, double gridTop, const Rect& r, float value) {
+    const int c0 = std::max(0, int(std::floor((r.left() - gridLeft) / CellSize)));
+    const int c1 = std::min(GridCols - 1, int(std::floor((r.right() - gridLeft) / CellSize)));
+    const int r0 = std::max(0, int(std::floor((r.top() - gridTop) / CellSize)));
+    const int r1 = std::min(GridRows - 1, int(std::floor((r.bottom() - gridTop) / CellSize)));
+    for (int row = r0; row <= r1; ++row)
+        for (int col = c0; col <= c1; ++col) grid[row * GridCols + col] = value;
+}
+
+void senseLevel(const LevelData& level, const SimState& state, float* inputs) {
+    const double half = SimConfig::PlayerExtent / 2;
+    const double cx = state.x + half;
+    const double cy = state.y + half;
+    const double gridLeft = cx - GridCols * CellSize / 2;
+    const double gridTop = cy - GridRows * CellSize / 2;
+
+    // Platforms are +1, spikes -1 (spikes win when both are in a cell), and
+    // outside the scene counts as a wall
+    std::fill(inputs, inputs + Inputs, 0.0f);
+    const Rect& b = level.bounds;
+    markCells(inputs, gridLeft, gridTop, Rect{b.left() - 1000, b.top() - 1000, 1000, b.h + 2000}, 1.0f);
+    markCells(inputs, gridLeft, gridTop, Rect{b.right(), b.top() - 1000, 1000, b.h + 2000}, 1.0f);
+    markCells(inputs, gridLeft, gridTop, Rect{b.left(), b.bottom(), b.w, 1000}, 1.0f);
+    for (const Rect& platform : level.platforms) markCells(inputs, gridLeft, gridTop, platform, 1.0f);
+
+    // Hills: each grid column is solid from the highest ground under it down
+    // (flat levels already have their floor from the wall above)
+    if (!level.terrain.empty()) {
+        for (int col = 0; col < GridCols; ++col) {
+            const double top = groundTop(level, gridLeft + col * CellSize, CellSize);
+            const int firstRow = std::max(0, int(std::floor((top - gridTop) / CellSize)));
+            for (int row = firstRow; row < GridRows; ++row) inputs[row * GridCols + col] = 1.0f;
+        }
+    }
+    for (const Triangle& spike : level.spikes) {
+        const double left = std::min({spike.apex.x, spike.left.x, spike.right.x});
+        const double right = std::max({spike.apex.x, spike.left.x, spike.right.x});
+        const double top = std::min({spike.apex.y, spike.left.y, spike.right.y});
+        const double bottom = std::max({spike.apex.y, spike.left.y, spike.right.y});
+        markCells(inputs, gridLeft, gridTop, Rect{left, top, right - left, bottom - top}, -1.0f);
+    }
+
+    // Where the goal is, scaled so the whole scene is about -1 to 1
+    float* extra = inputs + GridInputs;
+    extra[0] = float((level.goal.x + level.goal.w / 2 - cx) / b.w * 2);
+    extra[1] = float((level.goal.y + level.goal.h / 2 - cy) / b.h * 2);
+    extra[2] = float(state.verticalVelocity) / float(SimConfig::JumpVelocity);
+
+    // Standing on something: the ground (the bottom of the scene, or the hills) or a platform right below
+    bool ground = state.y + SimConfig::PlayerExtent >= groundTop(level, state.x, SimConfig::PlayerExtent);
+    for (const Rect& platform : level.platforms) {
+        const Rect top = platform.adjusted(LevelConfig::PenHalfWidth);
+        if (state.x + SimConfig::PlayerExtent > top.left() && state.x < top.right() &&
+            std::abs(state.y + SimConfig::PlayerExtent - top.top()) < 0.01)
+            ground = true;
+    }
+    extra[3] = ground ? 1.0f : 0.0f;
+}
+
+//-----------------------------------------
+// tanh is the slow part of a small network. This rational version is close
+// enough between -3 and 3 (and clamped outside), and has no branches, so the
+// compiler can do a whole row of neurons at once.
+static inline float fastTanh(float x) {
+    x = std::min(3.0f, std::max(-3.0f, x));
+    const float x2 = x * x;
+    return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+}
+
+// The loops below run along the neurons (16 or 3 values in a row in memory) so
+// they compile to SIMD adds and multiplies. Inputs that are zero (most of
+// the grid) are skipped.
+uint8_t evaluateNetwork(const float* weights, const float* inputs) {
+    const float* inputWeights = weights;
+    const float* hiddenBias = inputWeights + Inputs * Hidden;
+    const float* outputWeights = hiddenBias + Hidden;
+    const float* outputBias = outputWeights + Hidden * Outputs;
+
+    alignas(32) float hidden[Hidden];
+    std::memcpy(hidden, hiddenBias, sizeof(hidden));
+    for (int i = 0; i < Inputs; ++i) {
+        const float x = inputs[i];
+        if (x == 0.0f) continue;
+        const float* row = inputWeights + i * Hidden;
+        for (int h = 0; h < Hidden; ++h) hidden[h] += x * row[h];
+    }
+    for (int h = 0; h < Hidden; ++h) hidden[h] = fastTanh(hidden[h]);
+
+    float out[Outputs];
+    std::memcpy(out, outputBias, sizeof(out));
+    for (int h = 0; h < Hidden; ++h) {
+        const float* row = outputWeights + h * Outputs;
+        for (int o = 0; o < Outputs; ++o) out[o] += hidden[h] * row[o];
+    }
+
+    uint8_t input = 0;
+    if (out[0] > 0) input |= InputLeft;
+    if (out[1] > 0) input |= InputRight;
+    if (out[2] > 0) input |= InputJump;
+    return input;
+}
+
+//-----------------------------------------
+uint8_t NeuralBot::nextInput(const LevelData& level, const SimState& state) {
+    senseLevel(level, state, inputs);
+    return evaluateNetwork(genome.weights.data(), inputs);
+}
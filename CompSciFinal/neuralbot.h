@@ -0,0 +1,61 @@
+#ifndef NEURALBOT_H
+#define NEURALBOT_H
+
+// A bot driven by a small neural network. It sees a grid of what is around the
+// player (platforms, spikes and the ground), where the goal is and how fast it is falling,
+// and decides whether A, D and W are held. The weights are not written by hand:
+// tools/neuro_train evolves them on the headless engine.
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+
+//-----------------------------------------
+// Network size. Changing any of these makes old genome files unusable.
+namespace NeuralConfig {
+    constexpr int GridCols = 7;             // Cells around the player, left to right
+    constexpr int GridRows = 5;             // ...and top to bottom
+    constexpr double CellSize = 40;         // Pixels per cell
+    constexpr int GridInputs = GridCols * GridRows;
+    constexpr int Inputs = GridInputs + 4;  // Grid, goal dx/dy, velocity, ground below
+    constexpr int Hidden = 16;              // A multiple of 8, so a whole row fits SIMD registers
+    constexpr int Outputs = 3;              // A, D, W
+
+    // Weights of one network, laid out as: input->hidden (input-major), hidden bias,
+    // hidden->output (hidden-major), output bias
+    constexpr size_t WeightCount = size_t(Inputs) * Hidden + Hidden + size_t(Hidden) * Outputs + Outputs;
+}
+
+//-----------------------------------------
+// A genome is just the network's weights, stored as one flat array
+struct Genome {
+    std::vector<float> weights = std::vector<float>(NeuralConfig::WeightCount, 0.0f);
+};
+
+// Write / read a genome file. Both return false if the file could not be used.
+bool saveGenome(const std::string& path, const Genome& genome);
+bool loadGenome(const std::string& path, Genome& genome);
+
+// Fill "inputs" (NeuralConfig::Inputs values) with what the player can see
+void senseLevel(const LevelData& level, const SimState& state, float* inputs);
+
+// Run the network and turn its outputs into InputBits
+uint8_t evaluateNetwork(const float* weights, const float* inputs);
+
+//-----------------------------------------
+// Plays with a genome. Like SearchBot it only needs the state and the level, so it
+// can drive the Simulation or GameView.
+class NeuralBot {
+public:
+    explicit NeuralBot(const Genome& genome) : genome(genome) {}
+
+    uint8_t nextInput(const LevelData& level, const SimState& state);
+
+private:
+    Genome genome;
+    float inputs[NeuralConfig::Inputs];
+};
+
+#endif // NEURALBOT_H
@@ -0,0 +1,113 @@
+#include "parallax.h"
+
+#include <QPainterPath>
+
+#include <cmath>
+
+//-----------------------------------------
+// The layer tiles. They are only drawn here, once.
+static QImage drawHillsTile(double scale) {
+    const int w = 600, h = 140;
+    QImage tile(qRound(w * scale), qRound(h * scale), QImage::Format_ARGB32_Premultiplied);
+    tile.fill(Qt::transparent);
+
+    // A wavy line whose ends meet at the same height, so the tiles join up
+    const double pi = 3.14159265358979323846;
+    QPainterPath path(QPointF(0, h));
+    for (int x = 0; x <= w; x += 10) {
+        const double t = x * 2 * pi / w;
+        path.lineTo(x, h - 70 - 35 * std::sin(t) - 20 * std::sin(3 * t + 1));
+    }
+    path.lineTo(w, h);
+    path.closeSubpath();
+
+    QPainter painter(&tile);
+    painter.scale(scale, scale);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(150, 190, 205));
+    painter.drawPath(path);
+    painter.end();
+    return tile;
+}
+
+static QImage drawCloudsTile(double scale) {
+    const int w = 700, h = 110;
+    QImage tile(qRound(w * scale), qRound(h * scale), QImage::Format_ARGB32_Premultiplied);
+    tile.fill(Qt::transparent);
+
+    // Each cloud is a few overlapping ellipses
+    struct Puff { double x, y, w, h; };
+    static const Puff puffs[] = {
+        {40, 40, 90, 34},  {85, 25, 70, 40},   {120, 45, 80, 28},
+        {330, 60, 110, 30}, {380, 45, 70, 36}, {420, 62, 60, 24},
+        {560, 20, 80, 28},  {600, 12, 50, 30},
+    };
+
+    QPainter painter(&tile);
+    painter.scale(scale, scale);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(255, 255, 255, 200));
+    for (const Puff& p : puffs) painter.drawEllipse(QRectF(p.x, p.y, p.w, p.h));
+    painter.end();
+    return tile;
+}
+
+//-----------------------------------------
+ParallaxBackground::ParallaxBackground() : sky(173, 216, 230) {
+    layers.push_back(ParallaxLayer{drawHillsTile, drawHillsTile(1), 0.2, 0.0, -1});
+    layers.push_back(ParallaxLayer{drawCloudsTile, drawCloudsTile(1), 0.5, 0.25, 20});
+}
+
+const ParallaxBackground& ParallaxBackground::builtIn() {
+    static const ParallaxBackground background;
+    return background;
+}
+
+bool ParallaxBackground::animated() const {
+    for (const ParallaxLayer& layer : layers)
+        if (layer.driftPerTick != 0) return true;
+    return false;
+}
+
+//-----------------------------------------
+void ParallaxBackground::draw(QPainter& painter, const QRectF& exposed, const QRectF& camera, uint32_t tick) const {
+    painter.fillRect(exposed, sky);
+
+    // Pixmaps belong to the GUI thread; tools paint QImages on worker threads.
+    // On screen the tiles are redrawn to match the scale the view is using, so
+    // they stay sharp when the window is resized or on a HiDPI screen.
+    const bool onScreen = !(painter.device() && painter.device()->devType() == QInternal::Image);
+    if (onScreen) {
+        const QTransform& t = painter.worldTransform();
+        const double scale = std::sqrt(std::abs(t.determinant())) * painter.device()->devicePixelRatioF();
+        if (pixmaps.empty() || std::abs(scale - pixmapScale) > 1e-3) {
+            pixmaps.clear();
+            for (const ParallaxLayer& layer : layers) {
+                pixmaps.push_back(QPixmap::fromImage(layer.drawTile(scale)));
+                pixmaps.back().setDevicePixelRatio(scale);
+            }
+            pixmapScale = scale;
+        }
+    }
+
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const ParallaxLayer& layer = layers[i];
+        const double w = layer.tile.width();
+        const double h = layer.tile.height();
+        const double top = layer.fromTop < 0 ? camera.bottom() - h : camera.top() + layer.fromTop;
+        if (top >= exposed.bottom() || top + h <= exposed.top()) continue;
+
+        // How far the layer has slid, as a place inside one tile
+        const double scroll = camera.left() * layer.depth + layer.driftPerTick * tick;
+        double x = camera.left() - std::fmod(scroll, w);
+        if (x > camera.left()) x -= w;
+
+        for (; x < exposed.right(); x += w) {
+            if (x + w <= exposed.left()) continue;
+            if (onScreen) painter.drawPixmap(QPointF(x, top), pixmaps[i]);
+            else painter.drawImage(QPointF(x, top), layer.tile);
+        }
+    }
+}
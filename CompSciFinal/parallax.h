@@ -0,0 +1,50 @@
+#ifndef PARALLAX_H
+#define PARALLAX_H
+
+// The sky behind the level: a few layers (far hills, clouds) that each move at
+// their own speed as the camera moves, so the far ones look further away.
+// Every layer is drawn once into a tile, at the window's scale (and the
+// screen's pixel ratio). A frame only fills the sky colour and copies each tile
+// to its place a few times; the shapes are drawn again only if the scale changes.
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRectF>
+
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------
+// One layer: a tile repeated sideways
+struct ParallaxLayer {
+    QImage (*drawTile)(double scale);   // Draws the tile with "scale" pixels per world unit
+    QImage tile;                        // drawTile(1), for painting into images
+    double depth;          // 0 stays put on screen, 1 moves with the level
+    double driftPerTick;   // Pixels it slides left every tick, even with a still camera
+    double fromTop;        // Top of the layer below the top of the camera (-1 = sits on the bottom)
+};
+
+//-----------------------------------------
+class ParallaxBackground {
+public:
+    ParallaxBackground();   // The built-in sky: light blue, far hills and clouds
+
+    // The background every painter uses unless it is given another one
+    static const ParallaxBackground& builtIn();
+
+    // True if the layers move without the camera, so the background has to be
+    // redrawn every tick
+    bool animated() const;
+
+    // Draw the part "exposed" of the background, for a camera showing "camera"
+    // (both in scene units) at game tick "tick"
+    void draw(QPainter& painter, const QRectF& exposed, const QRectF& camera, uint32_t tick) const;
+
+private:
+    QColor sky;
+    std::vector<ParallaxLayer> layers;
+    mutable std::vector<QPixmap> pixmaps;   // Screen copies of the tiles, made on the first draw on screen
+    mutable double pixmapScale = 0;         // Screen pixels per world unit "pixmaps" were drawn at
+};
+
+#endif // PARALLAX_H
@@ -0,0 +1,151 @@
+#include "pathgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simulation.h"
+
+using namespace LevelConfig;
+
+//-----------------------------------------
+// Numbers for the chain of jumps. They stay well inside what the physics allow
+// (a jump rises 190px), so a person can make every jump too, not just a bot.
+namespace PathConfig {
+    constexpr double MinRise = 45;          // Smallest height between two chain platforms
+    constexpr double MaxRise = 120;         // Largest height between two chain platforms
+    constexpr double LandingMargin = 10;    // Clearance above a platform before landing on it
+    constexpr double ReachSafety = 0.7;     // Use this much of the sideways reach
+    constexpr double FloorClearance = 40;   // Keep platforms this far above the floor
+    constexpr double PerchBelowGoal = 25;   // Gap between the goal and the platform under it
+    constexpr int ExtraDistractors = 3;     // Decoration beyond NumPlatforms
+    constexpr int PlacementTries = 30;
+}
+
+using namespace PathConfig;
+
+//-----------------------------------------
+// Follow the jump arc tick by tick (the same way Simulation::step() moves the
+// player) and count the ticks spent above "rise". Moving sideways the whole time
+// covers MoveSpeed pixels per tick.
+double jumpReach(double rise) {
+    int velocity = SimConfig::JumpVelocity;
+    double height = 0;
+    int ticksAbove = 0;
+    for (int tick = 0; tick < 1000; ++tick) {
+        velocity -= SimConfig::Gravity;
+        height += velocity;
+        if (height >= rise + LandingMargin) ticksAbove = tick + 1;
+        else if (velocity < 0) break;   // Falling and already below the target
+    }
+    if (ticksAbove == 0) return -1;
+    return ticksAbove * SimConfig::MoveSpeed * ReachSafety - SimConfig::PlayerExtent;
+}
+
+// The highest point of a jump above where it started
+static double jumpPeak() {
+    double height = 0;
+    for (int velocity = SimConfig::JumpVelocity - SimConfig::Gravity; velocity > 0; velocity -= SimConfig::Gravity)
+        height += velocity;
+    return height;
+}
+
+//-----------------------------------------
+// The space the player moves through while jumping from "lower" to "upper".
+// Nothing that could catch or kill the player is allowed inside it.
+static Rect jumpCorridor(const Rect& lower, const Rect& upper, double peak) {
+    const double left = std::min(lower.left(), upper.left()) - SimConfig::PlayerExtent;
+    const double right = std::max(lower.right(), upper.right()) + SimConfig::PlayerExtent;
+    const double top = std::min(lower.top(), upper.top()) - peak - SimConfig::PlayerExtent;
+    const double bottom = std::max(lower.bottom(), upper.bottom());
+    return Rect{left, top, right - left, bottom - top};
+}
+
+//-----------------------------------------
+LevelData generatePathFirstLevel(uint64_t runSeed, int levelIndex, const Rect& bounds) {
+    LevelData level;
+    level.bounds = bounds;
+    level.spawn = Vec2{bounds.w / 2, bounds.h - PlayerSize};
+    const Vec2 spawnPos = level.spawn;
+
+    // Its own stream of numbers, so this generator's levels do not look like the classic ones
+    Rng rng(levelSeed(runSeed, levelIndex) ^ 0x5041544846495253ull);
+
+    // The goal: same rule as the classic generator (top half, away from spawn)
+    Vec2 winPos;
+    do {
+        winPos = Vec2{rng.bounded(bounds.w - GoalSize), rng.bounded(bounds.h / 2)};
+    } while (std::hypot(winPos.x - spawnPos.x, winPos.y - spawnPos.y) < 150);
+    level.goal = Rect{winPos.x, winPos.y, GoalSize, GoalSize};
+
+    //-----------------------------------------
+    // 1. The chain, built from the top down. It starts with a perch right under the
+    //    goal (one jump from it touches the goal) and every platform below is placed
+    //    within jumping reach of the one above, until the floor is close enough.
+    const double floorTop = bounds.bottom();
+    const double peak = jumpPeak();
+    std::vector<Rect> chain;
+    chain.push_back(Rect{std::clamp(winPos.x + GoalSize / 2 - PlatformWidth / 2, 0.0, bounds.w - PlatformWidth),
+                         winPos.y + GoalSize + PerchBelowGoal, PlatformWidth, PlatformHeight});
+
+    while (floorTop - chain.back().top() > MaxRise) {
+        const Rect& upper = chain.back();
+        const double room = floorTop - FloorClearance - PlatformHeight - upper.top();
+        const double rise = std::min(MinRise + rng.bounded(MaxRise - MinRise), room);
+        const double reach = jumpReach(rise);
+
+        // Sideways: anything from half under the upper platform to the edge of the reach
+        const double gap = -PlatformWidth / 2 + rng.bounded(reach + PlatformWidth / 2);
+        bool toLeft = rng.bounded(0, 2) == 0;
+        if (toLeft && upper.left() - gap - PlatformWidth < 0) toLeft = false;
+        if (!toLeft && upper.right() + gap + PlatformWidth > bounds.w) toLeft = true;
+        const double x = toLeft ? upper.left() - gap - PlatformWidth : upper.right() + gap;
+
+        // Clamping only ever moves it closer to the platform above
+        chain.push_back(Rect{std::clamp(x, 0.0, bounds.w - PlatformWidth), upper.top() + rise, PlatformWidth,
+                             PlatformHeight});
+    }
+
+    // The spaces every jump of the chain needs, from the floor to the goal
+    std::vector<Rect> corridors;
+    const Rect& lowest = chain.back();
+    corridors.push_back(jumpCorridor(Rect{lowest.x, floorTop, lowest.w, 0}, lowest, peak));
+    for (size_t i = chain.size() - 1; i > 0; --i) corridors.push_back(jumpCorridor(chain[i], chain[i - 1], peak));
+    corridors.push_back(jumpCorridor(chain.front(), level.goal, peak));
+
+    level.platforms.reserve(chain.size() + NumPlatforms + ExtraDistractors);
+    for (size_t i = chain.size(); i-- > 0;) level.platforms.push_back(chain[i]);
+
+    //-----------------------------------------
+    // 2. Decoration: more platforms (some with spikes) wherever they keep clear of
+    //    the corridors and of each other. A spot that does not fit is just skipped.
+    const int distractors = std::max(0, NumPlatforms - int(chain.size())) + ExtraDistractors;
+    for (int d = 0; d < distractors; ++d) {
+        for (int attempt = 0; attempt < PlacementTries; ++attempt) {
+            const double x = rng.bounded(bounds.w - PlatformWidth);
+            const double y = PlatformHeight + SpikeHeight +
+                             rng.bounded(floorTop - FloorClearance - 2 * PlatformHeight - SpikeHeight);
+            const Rect platform{x, y, PlatformWidth, PlatformHeight};
+
+            // The platform with room for a spike on top and its pen
+            const Rect footprint{x - PenHalfWidth, y - SpikeHeight - PenHalfWidth, PlatformWidth + 2 * PenHalfWidth,
+                                 PlatformHeight + SpikeHeight + 2 * PenHalfWidth};
+            const bool blocked = std::any_of(corridors.begin(), corridors.end(),
+                                             [&](const Rect& c) { return c.intersects(footprint); }) ||
+                                 std::any_of(level.platforms.begin(), level.platforms.end(),
+                                             [&](const Rect& p) { return p.adjusted(20).intersects(footprint); }) ||
+                                 footprint.intersects(level.goal.adjusted(20));
+            if (blocked) continue;
+
+            level.platforms.push_back(platform);
+            if (rng.bounded(0, 100) < SpikeChancePercent) {
+                const int spikeOffset = rng.bounded(10, 70);
+                level.spikes.push_back(Triangle{Vec2{x + spikeOffset + 10, y - SpikeHeight},
+                                                Vec2{x + spikeOffset, y},
+                                                Vec2{x + spikeOffset + SpikeWidth, y}});
+            }
+            break;
+        }
+    }
+
+    return level;
+}
@@ -0,0 +1,19 @@
+#ifndef PATHGENERATOR_H
+#define PATHGENERATOR_H
+
+// The path-first generator. The classic one scatters platforms and hopes they
+// connect; this one first lays down a chain of platforms where every jump is
+// known to be possible (worked out from the jump physics), and only then adds
+// extra platforms and spikes in places that cannot block that chain.
+// Every level it makes can be finished, with no retries.
+#include "level.h"
+
+// Level "levelIndex" (1 or more) of the run "runSeed"
+LevelData generatePathFirstLevel(uint64_t runSeed, int levelIndex, const Rect& bounds);
+
+// How far one jump can safely go: "rise" pixels up (negative = down) and at most
+// the returned number of pixels sideways between the edges of two platforms.
+// Returns a negative number if the rise is out of reach.
+double jumpReach(double rise);
+
+#endif // PATHGENERATOR_H
@@ -0,0 +1,56 @@
+#include "replay.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "binaryio.h"
+
+//-----------------------------------------
+// File layout (all numbers little-endian):
+//   "CSFR"  magic
+//   u32     version
+//   u64     seed
+//   f64     scene width, f64 scene height
+//   u8      level generator
+//   u32     tick count, then one input byte per tick
+//
+// Version 3 came with checkpoints. The layout is the same as version 2, but a
+// run recorded without checkpoints plays out differently after the first death
+// that follows one, so older replays are refused instead of quietly going wrong.
+static const char ReplayMagic[4] = {'C', 'S', 'F', 'R'};
+static const uint32_t ReplayVersion = 3;
+
+bool saveReplay(const std::string& path, const Replay& replay) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    out.write(ReplayMagic, 4);
+    writeLE(out, ReplayVersion);
+    writeLE(out, replay.seed);
+    writeLE(out, replay.width);
+    writeLE(out, replay.height);
+    writeLE(out, uint8_t(replay.generator));
+    writeLE(out, uint32_t(replay.inputs.size()));
+    out.write(reinterpret_cast<const char*>(replay.inputs.data()), std::streamsize(replay.inputs.size()));
+    return bool(out);
+}
+
+bool loadReplay(const std::string& path, Replay& replay) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint32_t version = 0, ticks = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, ReplayMagic, 4) != 0) return false;
+    if (!readLE(in, version) || version != ReplayVersion) return false;
+    if (!readLE(in, replay.seed) || !readLE(in, replay.width) || !readLE(in, replay.height)) return false;
+
+    uint8_t generator = 0;
+    if (!readLE(in, generator)) return false;
+    if (generator >= LevelGeneratorCount) return false;
+    replay.generator = LevelGenerator(generator);
+    if (!readLE(in, ticks)) return false;
+
+    replay.inputs.resize(ticks);
+    return bool(in.read(reinterpret_cast<char*>(replay.inputs.data()), std::streamsize(ticks)));
+}
@@ -0,0 +1,25 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// A replay is the run seed, the scene size, the level generator and one input
+// byte per tick.
+// That is all the Simulation needs to play a recorded run again exactly.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "level.h"
+
+struct Replay {
+    uint64_t seed = 0;
+    double width = 1000;             // Scene size the run was played at
+    double height = 500;
+    LevelGenerator generator = LevelGenerator::Classic;   // How the run's levels were built
+    std::vector<uint8_t> inputs;     // InputBits for every tick, in order
+};
+
+// Write / read a replay file. Both return false if the file could not be used.
+bool saveReplay(const std::string& path, const Replay& replay);
+bool loadReplay(const std::string& path, Replay& replay);
+
+#endif // REPLAY_H
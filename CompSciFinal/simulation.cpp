@@ -0,0 +1,202 @@
+#include "simulation.h"
+
+#include "speedrun.h"
+#include "terrain.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SimConfig;
+
+//-----------------------------------------
+// The player's shape in the scene: its 20x20 rect plus half a pixel of pen on each side
+static Rect playerShape(double x, double y) {
+    return Rect{x, y, LevelConfig::PlayerSize, LevelConfig::PlayerSize}.adjusted(LevelConfig::PenHalfWidth);
+}
+
+//-----------------------------------------
+// The goal is a circle; we find the closest point of the player box to its centre
+bool playerTouchesGoal(double x, double y, const Rect& goal) {
+    const Rect box = playerShape(x, y);
+    const double radius = goal.w / 2 + LevelConfig::PenHalfWidth;
+    const double cx = goal.x + goal.w / 2;
+    const double cy = goal.y + goal.h / 2;
+    const double dx = cx - std::clamp(cx, box.left(), box.right());
+    const double dy = cy - std::clamp(cy, box.top(), box.bottom());
+    return dx * dx + dy * dy < radius * radius;
+}
+
+//-----------------------------------------
+// Box against triangle with the separating axis test: if any axis keeps the two
+// shapes apart (by more than the spike's pen), they do not touch.
+bool playerTouchesSpike(double x, double y, const Triangle& spike) {
+    const double margin = LevelConfig::PenHalfWidth;
+    const Rect box = playerShape(x, y);
+    const Vec2 pts[3] = {spike.apex, spike.left, spike.right};
+
+    // Axis 1 and 2: the box's own x and y directions
+    const double minX = std::min({pts[0].x, pts[1].x, pts[2].x});
+    const double maxX = std::max({pts[0].x, pts[1].x, pts[2].x});
+    const double minY = std::min({pts[0].y, pts[1].y, pts[2].y});
+    const double maxY = std::max({pts[0].y, pts[1].y, pts[2].y});
+    if (maxX + margin <= box.left() || minX - margin >= box.right()) return false;
+    if (maxY + margin <= box.top() || minY - margin >= box.bottom()) return false;
+
+    // Axis 3 to 5: the normal of each triangle edge
+    const Vec2 corners[4] = {{box.left(), box.top()}, {box.right(), box.top()},
+                             {box.left(), box.bottom()}, {box.right(), box.bottom()}};
+    for (int i = 0; i < 3; ++i) {
+        const Vec2& a = pts[i];
+        const Vec2& b = pts[(i + 1) % 3];
+        const double length = std::hypot(b.x - a.x, b.y - a.y);
+        const double nx = -(b.y - a.y) / length;
+        const double ny = (b.x - a.x) / length;
+
+        double triMin = 1e300, triMax = -1e300;
+        for (const Vec2& p : pts) {
+            const double d = p.x * nx + p.y * ny;
+            triMin = std::min(triMin, d);
+            triMax = std::max(triMax, d);
+        }
+        double boxMin = 1e300, boxMax = -1e300;
+        for (const Vec2& p : corners) {
+            const double d = p.x * nx + p.y * ny;
+            boxMin = std::min(boxMin, d);
+            boxMax = std::max(boxMax, d);
+        }
+        if (triMax + margin <= boxMin || triMin - margin >= boxMax) return false;
+    }
+    return true;
+}
+
+//-----------------------------------------
+Simulation::Simulation(uint64_t seed, const Rect& bounds, LevelGenerator generator)
+    : runSeed(seed), bounds(bounds), levelGenerator(generator) {
+    loadLevel(0);
+    current.x = levelData.spawn.x;
+    current.y = levelData.spawn.y;
+}
+
+void Simulation::loadLevel(int levelIndex) {
+    levelData = generateLevelData(runSeed, levelIndex, bounds, levelGenerator);
+    contacts.build(levelData);
+}
+
+void Simulation::restore(const SimState& snap) {
+    if (snap.level != current.level) loadLevel(snap.level);
+    current = snap;
+    contacts.reset();
+}
+
+
+//-----------------------------------------
+// This follows GameView::updatePosition() line by line.
+void movePlayer(const LevelData& levelData, const Rect& bounds, SimState& s, uint8_t input) {
+    // Move left and right
+    double x = s.x;
+    if (input & InputRight) x += MoveSpeed;
+    if (input & InputLeft) x -= MoveSpeed;
+
+    // Simulate gravity by reducing upward velocity
+    s.verticalVelocity -= Gravity;
+    double nextX = x;
+    double nextY = s.y - s.verticalVelocity; // Y is inverted in Qt
+
+    bool onGround = false;
+
+    // Check for collision with any platform (sceneBoundingRect() includes the pen)
+    const Rect playerNextRect{nextX, nextY, PlayerExtent, PlayerExtent};
+    for (const Rect& platform : levelData.platforms) {
+        const Rect platRect = platform.adjusted(LevelConfig::PenHalfWidth);
+
+        // Only land if falling down and above the platform
+        if (playerNextRect.intersects(platRect) && s.verticalVelocity <= 0 &&
+            s.y + PlayerExtent <= platRect.top()) {
+            nextY = platRect.top() - PlayerExtent;
+            s.verticalVelocity = 0;
+            onGround = true;
+            break;
+        }
+    }
+
+    // Stop the fall if player hits the ground (the bottom of the scene, or the terrain under it)
+    const double ground = groundTop(levelData, nextX, PlayerExtent);
+    if (nextY >= ground - PlayerExtent) {
+        nextY = ground - PlayerExtent;
+        onGround = true;
+        s.verticalVelocity = 0;
+    }
+
+    // Jump when pressing W while on ground
+    if ((input & InputJump) && onGround) {
+        s.verticalVelocity = JumpVelocity;
+    }
+
+    // Prevent the player from leaving screen horizontally
+    s.x = std::clamp(nextX, bounds.left(), bounds.right() - PlayerExtent);
+    s.y = nextY;
+}
+
+//-----------------------------------------
+bool saveCheckpoint(SimState& s, const std::vector<ContactEvent>& events) {
+    for (const ContactEvent& e : events) {
+        if (e.kind != ContactCheckpoint || e.change != ContactEnter || int32_t(e.index) == s.checkpoint.index) continue;
+        s.checkpoint = Checkpoint{s.x, s.y, s.verticalVelocity, int32_t(e.index)};
+        return true;
+    }
+    return false;
+}
+
+void respawnPlayer(SimState& s, const Vec2& spawn) {
+    if (s.checkpoint.index < 0) {
+        s.x = spawn.x;
+        s.y = spawn.y;
+        return;
+    }
+    s.x = s.checkpoint.x;
+    s.y = s.checkpoint.y;
+    s.verticalVelocity = s.checkpoint.verticalVelocity;
+}
+
+// The rest of updatePosition(): winning, dying and checkpoints
+uint8_t Simulation::step(uint8_t input) {
+    // Stop the game if the player has died too many times
+    if (gameOver()) return StepGameOver;
+
+    uint8_t events = StepNone;
+    SimState& s = current;
+    ++s.tick;
+
+    const double fromX = s.x, fromY = s.y;
+    movePlayer(levelData, bounds, s, input);
+
+    // Find what the player started touching
+    contacts.update(s.x, s.y, contactEvents);
+
+    // Check for winning
+    if (contactEntered(contactEvents, ContactGoal)) {
+        goalFraction = goalTouchFraction(fromX, fromY, s.x, s.y, levelData.goal);
+        s.level++;
+        loadLevel(s.level);
+        s.x = levelData.spawn.x;
+        s.y = levelData.spawn.y;
+        s.checkpoint = Checkpoint{};
+        events |= StepWon;
+        contacts.update(s.x, s.y, contactEvents);   // The new level, at the spawn point
+    }
+
+    // Check for hitting a spike
+    if (contactEntered(contactEvents, ContactSpike)) {
+        s.deaths++;
+        deathPos = Vec2{s.x, s.y};
+        respawnPlayer(s, levelData.spawn);
+        events |= StepDied;
+        contacts.reset();
+    }
+
+    // Check for a new checkpoint. The player is alive here, so it is not
+    // touching a spike and the snapshot is always a safe place to come back to.
+    if (!(events & (StepWon | StepDied))) saveCheckpoint(s, contactEvents);
+
+    return events;
+}
@@ -0,0 +1,128 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+// A headless copy of the game rules in GameView::updatePosition().
+// It has no Qt items or windows, so tools can replay and test runs
+// thousands of times faster than real time.
+#include "contacts.h"
+#include "level.h"
+
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------
+// One tick of player input stored as bits (this is what replays record).
+enum InputBits : uint8_t {
+    InputLeft = 1 << 0,    // A
+    InputRight = 1 << 1,   // D
+    InputJump = 1 << 2,    // W
+};
+
+//-----------------------------------------
+// What happened during a step, so callers can react (draw, count, stop...).
+enum StepEvents : uint8_t {
+    StepNone = 0,
+    StepWon = 1 << 0,        // Player touched the goal and a new level started
+    StepDied = 1 << 1,       // Player touched a spike and respawned
+    StepGameOver = 1 << 2,   // Out of lives, nothing moves anymore
+};
+
+//-----------------------------------------
+// Physics numbers, the same ones GameView uses.
+namespace SimConfig {
+    constexpr double MoveSpeed = 7;     // Pixels per tick left/right
+    constexpr int Gravity = 1;          // Velocity lost every tick
+    constexpr int JumpVelocity = 20;    // Velocity given by a jump
+    constexpr int MaxDeaths = 10;       // Lives before game over
+    constexpr int TickMs = 16;          // The game timer interval
+    // The player's boundingRect() is 1px bigger than its rect because of the pen
+    constexpr double PlayerExtent = LevelConfig::PlayerSize + 2 * LevelConfig::PenHalfWidth;
+}
+
+//-----------------------------------------
+// A snapshot of the player's movement, taken the tick a checkpoint is touched.
+// Dying puts the player back exactly as it was then (position and velocity).
+// It is 24 bytes, so every copy of the state carries it for almost nothing.
+struct Checkpoint {
+    double x = 0;
+    double y = 0;
+    int32_t verticalVelocity = 0;
+    int32_t index = -1;        // Which of LevelData::checkpoints (-1 = none yet: respawn at the spawn point)
+};
+
+//-----------------------------------------
+// Everything that changes while playing. It is small and plain on purpose:
+// copying it is a full snapshot of the game.
+struct SimState {
+    double x = 0;              // Player position (top-left, like player->pos())
+    double y = 0;
+    int verticalVelocity = 0;  // Used for jumping and falling
+    int deaths = 0;            // Number of times the player hit a spike
+    int level = 0;             // Number of levels completed
+    uint32_t tick = 0;         // Number of steps taken
+    Checkpoint checkpoint;     // Where a spike sends the player back to on this level
+};
+
+//-----------------------------------------
+// The headless game. Create it with a seed, then call step() once per tick.
+class Simulation {
+public:
+    explicit Simulation(uint64_t seed, const Rect& bounds = worldBounds(),
+                        LevelGenerator generator = LevelGenerator::Classic);
+
+    // Advance one tick (one timer timeout in GameView) with the given input bits
+    uint8_t step(uint8_t input);
+
+    const SimState& state() const { return current; }
+    const LevelData& level() const { return levelData; }
+    uint64_t seed() const { return runSeed; }
+    LevelGenerator generator() const { return levelGenerator; }
+    bool gameOver() const { return current.deaths >= SimConfig::MaxDeaths; }
+
+    // Where the player was when the last StepDied happened (before respawning)
+    Vec2 lastDeathPos() const { return deathPos; }
+
+    // How far through the tick (0 to 1) the goal was touched when the last
+    // StepWon happened, for speedrun times (see speedrun.h)
+    double lastGoalFraction() const { return goalFraction; }
+
+    // Snapshots are just a copy of the state. The level layout comes from the
+    // seed, so it is only rebuilt when restoring into a different level.
+    SimState snapshot() const { return current; }
+    void restore(const SimState& snap);
+
+private:
+    uint64_t runSeed;
+    Rect bounds;
+    LevelGenerator levelGenerator;
+    SimState current;
+    LevelData levelData;
+    Vec2 deathPos;
+    double goalFraction = 1;
+    ContactTracker contacts;                  // Finds the goal and spikes near the player
+    std::vector<ContactEvent> contactEvents;  // This tick's contacts (kept to reuse its memory)
+
+    void loadLevel(int levelIndex);
+};
+
+//-----------------------------------------
+// One tick of movement in "level": walking, gravity, landing on platforms or the
+// ground, jumping, and staying inside "bounds". Simulation::step() uses it, and
+// so do games with several players in one level.
+void movePlayer(const LevelData& level, const Rect& bounds, SimState& state, uint8_t input);
+
+// Snapshot the player into state.checkpoint if "events" has it touching a
+// checkpoint it isn't already using. True if it did.
+bool saveCheckpoint(SimState& state, const std::vector<ContactEvent>& events);
+
+// After a spike: back to the last checkpoint, or to "spawn" on a level
+// without one (the velocity is kept then, as it always was)
+void respawnPlayer(SimState& state, const Vec2& spawn);
+
+//-----------------------------------------
+// Shape tests that copy what collidesWithItem() sees for our Qt items
+// (each shape is outlined by a 1px pen, so it is half a pixel bigger).
+bool playerTouchesGoal(double x, double y, const Rect& goal);
+bool playerTouchesSpike(double x, double y, const Triangle& spike);
+
+#endif // SIMULATION_H
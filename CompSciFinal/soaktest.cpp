@@ -0,0 +1,122 @@
+#include "soaktest.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "gameview.h"
+#include "metrics.h"
+
+//-----------------------------------------
+SoakTest::SoakTest(GameView* view, quint64 seed, const SoakConfig& config, QObject* parent)
+    : QObject(parent), view(view), config(config), seed(seed) {
+    // A zero timer runs a batch every time the event loop is free, so the
+    // window still repaints between batches
+    batchTimer.setInterval(0);
+    connect(&batchTimer, &QTimer::timeout, this, &SoakTest::runBatch);
+}
+
+void SoakTest::start() {
+    const QRectF bounds = view->scene()->sceneRect();
+    bot.reset(new SearchBot(seed, Rect{0, 0, bounds.width(), bounds.height()}, 1, view->generator()));
+    view->takeControl([this]() { return nextInput; });
+    lastLevel = view->simState().level;
+
+    std::printf("%8s %10s %9s %6s %9s %9s\n", "levels", "ticks", "rss_mb", "items", "p50_us", "p99_us");
+    batchTimer.start();
+}
+
+//-----------------------------------------
+// Run a batch of ticks, moving on when the bot finishes or gets stuck on a level
+void SoakTest::runBatch() {
+    for (int i = 0; i < config.ticksPerBatch; ++i) {
+        SimState state = view->simState();
+
+        // Out of lives: start a new run, the levels still count
+        if (state.deaths >= SimConfig::MaxDeaths) {
+            view->restartRun();
+            lastLevel = 0;
+            ticksOnLevel = 0;
+            continue;
+        }
+
+        // The bot's thinking time is not part of the tick time
+        nextInput = bot->nextInput(state);
+        QElapsedTimer tickTimer;
+        tickTimer.start();
+        view->advance();
+        windowTickNs.append(tickTimer.nsecsElapsed());
+        ticks++;
+
+        const int level = view->simState().level;
+        if (level == lastLevel && ++ticksOnLevel >= config.stuckTicks) {
+            // Some generated levels have no way through, so we skip them
+            view->skipLevel();
+        }
+
+        const int nowLevel = view->simState().level;
+        if (nowLevel == lastLevel) continue;
+        lastLevel = nowLevel;
+        ticksOnLevel = 0;
+        levelsDone++;
+
+        if (levelsDone % config.sampleEveryLevels == 0 || levelsDone >= config.levels) {
+            if (!takeSample()) return;
+        }
+        if (levelsDone >= config.levels) {
+            finish(true, QString());
+            return;
+        }
+    }
+}
+
+//-----------------------------------------
+// Record memory, items and tick times, then check them against the first sample
+bool SoakTest::takeSample() {
+    std::vector<qint64> sorted(windowTickNs.begin(), windowTickNs.end());
+    std::sort(sorted.begin(), sorted.end());
+    windowTickNs.clear();
+
+    SoakSample sample;
+    sample.levels = levelsDone;
+    sample.ticks = ticks;
+    sample.rssMB = residentMemoryBytes() / (1024.0 * 1024.0);
+    sample.sceneItems = view->sceneItemCount();
+    if (!sorted.empty()) {
+        sample.p50Us = sorted[sorted.size() / 2] / 1000.0;
+        sample.p99Us = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)] / 1000.0;
+    }
+    samples.append(sample);
+    std::printf("%8d %10lld %9.1f %6d %9.1f %9.1f\n", sample.levels, (long long)sample.ticks, sample.rssMB,
+                sample.sceneItems, sample.p50Us, sample.p99Us);
+    std::fflush(stdout);
+
+    // The scene should hold exactly the player, two HUD texts and the level item
+    const int expectedItems = 4;
+    if (sample.sceneItems != expectedItems) {
+        finish(false, QString("scene has %1 items, expected %2").arg(sample.sceneItems).arg(expectedItems));
+        return false;
+    }
+
+    const SoakSample& first = samples.first();
+    if (sample.rssMB - first.rssMB > config.maxRssGrowthMB) {
+        finish(false, QString("memory grew %1 MB since the first sample").arg(sample.rssMB - first.rssMB, 0, 'f', 1));
+        return false;
+    }
+    if (sample.p99Us > first.p99Us * config.maxLatencyRatio && sample.p99Us - first.p99Us > config.minLatencyGrowthUs) {
+        finish(false, QString("p99 tick time went from %1 us to %2 us").arg(first.p99Us, 0, 'f', 1).arg(sample.p99Us, 0, 'f', 1));
+        return false;
+    }
+    return true;
+}
+
+void SoakTest::finish(bool passed, const QString& reason) {
+    batchTimer.stop();
+    if (passed)
+        std::printf("Soak test passed: %d levels, %lld ticks\n", levelsDone, (long long)ticks);
+    else
+        std::printf("Soak test FAILED after %d levels: %s\n", levelsDone, qPrintable(reason));
+    std::fflush(stdout);
+    emit finished(passed);
+}
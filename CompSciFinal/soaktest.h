@@ -0,0 +1,69 @@
+#ifndef SOAKTEST_H
+#define SOAKTEST_H
+
+// Soak test: a bot plays the real game window through thousands of levels as
+// fast as it can, while we watch memory, scene items and tick times. Slow
+// leaks that nobody notices in a few minutes of play show up here.
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+
+#include "bot.h"
+
+class GameView;
+
+//-----------------------------------------
+// Limits and pacing for one soak run
+struct SoakConfig {
+    int levels = 2000;                 // Stop after this many levels
+    int sampleEveryLevels = 100;       // Take a sample this often
+    int ticksPerBatch = 500;           // Ticks run between repaints
+    int stuckTicks = 1500;             // Skip a level the bot can't finish in this many ticks
+    double maxRssGrowthMB = 32;        // Fail if memory grows more than this since the first sample
+    double maxLatencyRatio = 2.0;      // Fail if p99 tick time grows by this factor...
+    double minLatencyGrowthUs = 100;   // ...and by at least this much (ignores tiny noisy numbers)
+};
+
+//-----------------------------------------
+// One row of the report
+struct SoakSample {
+    int levels = 0;
+    qint64 ticks = 0;
+    double rssMB = 0;
+    int sceneItems = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+};
+
+class SoakTest : public QObject {
+    Q_OBJECT
+
+public:
+    SoakTest(GameView* view, quint64 seed, const SoakConfig& config, QObject* parent = nullptr);
+    void start();
+
+signals:
+    void finished(bool passed);
+
+private:
+    GameView* view;
+    SoakConfig config;
+    quint64 seed;
+    std::unique_ptr<SearchBot> bot;
+    QTimer batchTimer;
+    quint8 nextInput = 0;              // What the bot chose for the coming tick
+    int levelsDone = 0;
+    int lastLevel = 0;
+    int ticksOnLevel = 0;
+    qint64 ticks = 0;
+    QVector<qint64> windowTickNs;      // Tick times since the last sample
+    QVector<SoakSample> samples;
+
+    void runBatch();
+    bool takeSample();                 // Returns false if a limit was broken
+    void finish(bool passed, const QString& reason);
+};
+
+#endif // SOAKTEST_H
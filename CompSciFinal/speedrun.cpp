@@ -0,0 +1,134 @@
+#include "speedrun.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "binaryio.h"
+#include "simulation.h"
+
+//-----------------------------------------
+// The player touches the goal along a single stretch of the line (the goal is
+// a circle and the player a box, both convex), so if it does not touch at the
+// start but does at the end, halving the gap finds the first touch.
+double goalTouchFraction(double fromX, double fromY, double toX, double toY, const Rect& goal) {
+    if (playerTouchesGoal(fromX, fromY, goal)) return 0;
+    if (!playerTouchesGoal(toX, toY, goal)) return 1;
+
+    double outside = 0, inside = 1;
+    for (int i = 0; i < SpeedrunConfig::FractionSteps; ++i) {
+        const double mid = (outside + inside) / 2;
+        if (playerTouchesGoal(fromX + (toX - fromX) * mid, fromY + (toY - fromY) * mid, goal)) inside = mid;
+        else outside = mid;
+    }
+    return inside;
+}
+
+double goalTimeMs(uint32_t tick, double fraction) {
+    // Tick 1 moves the player from time 0 to time TickMs
+    return (double(tick) - 1 + fraction) * SimConfig::TickMs;
+}
+
+std::string formatRunTime(double ms) {
+    const long long total = std::llround(std::fabs(ms));
+    char text[32];
+    std::snprintf(text, sizeof(text), "%s%lld:%02lld.%03lld", ms < 0 ? "-" : "", total / 60000, total / 1000 % 60, total % 1000);
+    return text;
+}
+
+std::string formatTimeDelta(double ms) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%+.3f", ms / 1000);
+    return text;
+}
+
+//-----------------------------------------
+void SpeedrunTimer::goalReached(uint32_t tick, double fraction) {
+    if (finished()) return;
+    splits.push_back(goalTimeMs(tick, fraction));
+}
+
+double SpeedrunTimer::elapsedMs(uint32_t tick) const {
+    if (finished()) return splits.back();
+    return double(tick) * SimConfig::TickMs;
+}
+
+double SpeedrunTimer::levelTimeMs(int level) const {
+    const double end = splits[size_t(level)];
+    return level == 0 ? end : end - splits[size_t(level) - 1];
+}
+
+bool SpeedrunTimer::isNewBest() const {
+    if (!finished()) return false;
+    return best.size() < splits.size() || splits.back() < best[splits.size() - 1];
+}
+
+//-----------------------------------------
+// File layout (all numbers little-endian):
+//   "CSFP"  magic
+//   u32     version
+//   u32     entry count, then for each entry:
+//     u64 seed, u8 generator, u32 levels, then "levels" f64 split times
+static const char BestsMagic[4] = {'C', 'S', 'F', 'P'};
+static const uint32_t BestsVersion = 1;
+
+bool savePersonalBests(const std::string& path, const std::vector<PersonalBest>& bests) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    out.write(BestsMagic, 4);
+    writeLE(out, BestsVersion);
+    writeLE(out, uint32_t(bests.size()));
+    for (const PersonalBest& best : bests) {
+        writeLE(out, best.seed);
+        writeLE(out, uint8_t(best.generator));
+        writeLE(out, uint32_t(best.splits.size()));
+        for (double split : best.splits) writeLE(out, split);
+    }
+    return bool(out);
+}
+
+// How many bytes of the file are still to be read
+static uint64_t bytesLeft(std::istream& in) {
+    const std::streampos here = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(here);
+    return end > here ? uint64_t(end - here) : 0;
+}
+
+bool loadPersonalBests(const std::string& path, std::vector<PersonalBest>& bests) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, BestsMagic, 4) != 0) return false;
+    if (!readLE(in, version) || version != BestsVersion) return false;
+    if (!readLE(in, count)) return false;
+
+    bests.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        PersonalBest best;
+        uint8_t generator = 0;
+        uint32_t levels = 0;
+        if (!readLE(in, best.seed) || !readLE(in, generator) || !readLE(in, levels)) return false;
+        if (generator >= LevelGeneratorCount) return false;
+        best.generator = LevelGenerator(generator);
+        // A damaged count must not make us allocate gigabytes: the splits have to fit in the file
+        if (levels > bytesLeft(in) / sizeof(double)) return false;
+        best.levels = int(levels);
+        best.splits.resize(levels);
+        for (double& split : best.splits)
+            if (!readLE(in, split)) return false;
+        bests.push_back(best);
+    }
+    return true;
+}
+
+PersonalBest* findPersonalBest(std::vector<PersonalBest>& bests, uint64_t seed, LevelGenerator generator, int levels) {
+    for (PersonalBest& best : bests)
+        if (best.seed == seed && best.generator == generator && best.levels == levels) return &best;
+    return nullptr;
+}
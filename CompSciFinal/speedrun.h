@@ -0,0 +1,89 @@
+#ifndef SPEEDRUN_H
+#define SPEEDRUN_H
+
+// Time attack: a run timer with a split for every level and a comparison
+// against the personal best.
+//
+// Times never come from the computer's clock. They come from the tick count
+// (SimConfig::TickMs per tick) plus how far through the tick the player
+// touched the goal. That point is found by sliding the player from where it
+// started the tick to where it ended it. So a run has exactly the same times
+// when it is replayed, on any machine, and two runs that finish in the same
+// tick can still be told apart.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "level.h"
+
+//-----------------------------------------
+namespace SpeedrunConfig {
+    constexpr int FractionSteps = 32;   // Halvings when searching for the touch point (1/2^32 of a tick)
+}
+
+//-----------------------------------------
+// How far (0 to 1) through a tick the player, moving in a straight line from
+// (fromX, fromY) to (toX, toY), first touched the goal. 1 if it only touches at the end.
+double goalTouchFraction(double fromX, double fromY, double toX, double toY, const Rect& goal);
+
+// Run time of a goal touched "fraction" of the way through tick "tick" (ticks count from 1)
+double goalTimeMs(uint32_t tick, double fraction);
+
+// "1:02.345", or "-0.250" / "+1.500" for differences
+std::string formatRunTime(double ms);
+std::string formatTimeDelta(double ms);
+
+//-----------------------------------------
+class SpeedrunTimer {
+public:
+    // "levels" goals finish the run (0 = the run never finishes, only splits are kept)
+    explicit SpeedrunTimer(int levels = 0) : targetLevels(levels) {}
+
+    void reset() { splits.clear(); }
+
+    // Call when the goal is touched, with the tick it happened in
+    void goalReached(uint32_t tick, double fraction);
+
+    int levels() const { return targetLevels; }
+    bool finished() const { return targetLevels > 0 && int(splits.size()) >= targetLevels; }
+
+    // The clock shown while playing: stops at the last goal once finished
+    double elapsedMs(uint32_t tick) const;
+
+    // Time from the start of the run to each goal, and the time of one level alone
+    const std::vector<double>& splitTimes() const { return splits; }
+    double levelTimeMs(int level) const;
+
+    // The personal best to compare against (its split times, same layout)
+    void setPersonalBest(const std::vector<double>& bestSplits) { best = bestSplits; }
+    const std::vector<double>& personalBest() const { return best; }
+    bool hasBestFor(int level) const { return level >= 0 && level < int(best.size()); }
+    double deltaMs(int level) const { return splits[size_t(level)] - best[size_t(level)]; }   // Negative = ahead
+
+    // A finished run that is faster than the personal best (or the first one)
+    bool isNewBest() const;
+
+private:
+    int targetLevels;
+    std::vector<double> splits;
+    std::vector<double> best;
+};
+
+//-----------------------------------------
+// Personal bests are kept per seed, generator and run length, since each of
+// those makes a different race.
+struct PersonalBest {
+    uint64_t seed = 0;
+    LevelGenerator generator = LevelGenerator::Classic;
+    int levels = 0;
+    std::vector<double> splits;   // Split times of the best finished run
+};
+
+// Read / write the file of personal bests. Both return false if the file could not be used.
+bool loadPersonalBests(const std::string& path, std::vector<PersonalBest>& bests);
+bool savePersonalBests(const std::string& path, const std::vector<PersonalBest>& bests);
+
+// The entry for this race in "bests", or nullptr
+PersonalBest* findPersonalBest(std::vector<PersonalBest>& bests, uint64_t seed, LevelGenerator generator, int levels);
+
+#endif // SPEEDRUN_H
@@ -0,0 +1,146 @@
+#include "spriteatlas.h"
+
+#include <QPolygonF>
+
+#include <algorithm>
+
+using namespace SpriteConfig;
+
+//-----------------------------------------
+// Where each sprite is in the atlas (see the layout in spriteatlas.h)
+static const QRectF SpriteRects[SpriteCount] = {
+    QRectF(0, 0, 21, 21),    // SpritePlayer
+    QRectF(21, 0, 31, 31),   // SpriteGoal
+    QRectF(52, 0, 21, 11),   // SpriteSpike
+    QRectF(73, 0, 12, 12),   // SpritePlatform
+    QRectF(85, 0, 11, 21),   // SpriteCheckpoint
+};
+
+//-----------------------------------------
+// The built-in art: the shapes and colours the game has always used, each
+// outlined by a 1px black pen that sits just inside its cell
+static QImage drawBuiltInAtlas() {
+    QImage atlas(AtlasWidth, AtlasHeight, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+
+    QPainter painter(&atlas);
+    painter.setPen(QPen(Qt::black, 1));
+
+    painter.setBrush(Qt::blue);
+    painter.drawRect(SpriteRects[SpritePlayer].adjusted(0.5, 0.5, -0.5, -0.5));
+
+    painter.setBrush(Qt::darkGray);
+    painter.drawRect(SpriteRects[SpritePlatform].adjusted(0.5, 0.5, -0.5, -0.5));
+
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setBrush(Qt::yellow);
+    painter.drawEllipse(SpriteRects[SpriteGoal].adjusted(0.5, 0.5, -0.5, -0.5));
+
+    const QRectF spike = SpriteRects[SpriteSpike].adjusted(0.5, 0.5, -0.5, -0.5);
+    QPolygonF triangle;
+    triangle << QPointF(spike.center().x(), spike.top()) << spike.bottomLeft() << spike.bottomRight();
+    painter.setBrush(Qt::red);
+    painter.drawPolygon(triangle);
+
+    // The checkpoint: a green flag on a pole
+    const QRectF flag = SpriteRects[SpriteCheckpoint].adjusted(0.5, 0.5, -0.5, -0.5);
+    painter.drawLine(QPointF(flag.left() + 1, flag.top()), QPointF(flag.left() + 1, flag.bottom()));
+    QPolygonF pennant;
+    pennant << QPointF(flag.left() + 1, flag.top()) << QPointF(flag.right(), flag.top() + 4)
+            << QPointF(flag.left() + 1, flag.top() + 8);
+    painter.setBrush(Qt::green);
+    painter.drawPolygon(pennant);
+
+    painter.end();
+    return atlas;
+}
+
+SpriteAtlas::SpriteAtlas() : image(drawBuiltInAtlas()) {}
+
+const SpriteAtlas& SpriteAtlas::builtIn() {
+    static const SpriteAtlas atlas;
+    return atlas;
+}
+
+bool SpriteAtlas::load(const QString& path) {
+    QImage loaded(path);
+    if (loaded.isNull() || loaded.width() < OldAtlasWidth || loaded.height() < AtlasHeight) return false;
+
+    // An atlas made before the checkpoint sprite keeps the built-in one
+    if (loaded.width() < AtlasWidth) {
+        QImage full = drawBuiltInAtlas();
+        QPainter painter(&full);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(QRectF(0, 0, OldAtlasWidth, AtlasHeight), loaded, QRectF(0, 0, OldAtlasWidth, AtlasHeight));
+        painter.end();
+        loaded = full;
+    }
+    image = loaded.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    pixmap = QPixmap();
+    return true;
+}
+
+//-----------------------------------------
+// One piece: "source" in the atlas stretched over "target" in the scene
+static void addPiece(SpriteBatch& batch, const QRectF& source, const QRectF& target) {
+    if (source.isEmpty() || target.isEmpty()) return;
+    batch.append(QPainter::PixmapFragment::create(target.center(), source, target.width() / source.width(),
+                                                  target.height() / source.height()));
+}
+
+void SpriteAtlas::addSprite(SpriteBatch& batch, Sprite sprite, const QRectF& target) const {
+    const QRectF& source = SpriteRects[sprite];
+    if (sprite != SpritePlatform) {
+        addPiece(batch, source, target);
+        return;
+    }
+
+    // Nine-slice: corners keep their size, edges stretch one way, the middle both.
+    // A platform thinner than two borders just shares its height between them.
+    const double border = std::min<double>(PlatformSlice, std::min(target.width(), target.height()) / 2);
+    const double sx[4] = {source.left(), source.left() + PlatformSlice, source.right() - PlatformSlice, source.right()};
+    const double sy[4] = {source.top(), source.top() + PlatformSlice, source.bottom() - PlatformSlice, source.bottom()};
+    const double tx[4] = {target.left(), target.left() + border, target.right() - border, target.right()};
+    const double ty[4] = {target.top(), target.top() + border, target.bottom() - border, target.bottom()};
+    for (int row = 0; row < 3; ++row)
+        for (int col = 0; col < 3; ++col)
+            addPiece(batch, QRectF(QPointF(sx[col], sy[row]), QPointF(sx[col + 1], sy[row + 1])),
+                     QRectF(QPointF(tx[col], ty[row]), QPointF(tx[col + 1], ty[row + 1])));
+}
+
+void SpriteAtlas::addLevel(SpriteBatch& batch, const LevelData& level, const QRectF& visible) const {
+    const double pen = LevelConfig::PenHalfWidth;
+    auto add = [&](Sprite sprite, const Rect& r) {
+        const QRectF target(r.x - pen, r.y - pen, r.w + 2 * pen, r.h + 2 * pen);
+        if (target.intersects(visible)) addSprite(batch, sprite, target);
+    };
+
+    // Same order as the items used to be stacked: platforms, spikes, then the goal
+    // (checkpoints came later and go just under the goal)
+    for (const Rect& platform : level.platforms) add(SpritePlatform, platform);
+    for (const Triangle& t : level.spikes) {
+        const double left = std::min({t.apex.x, t.left.x, t.right.x});
+        const double top = std::min({t.apex.y, t.left.y, t.right.y});
+        add(SpriteSpike, Rect{left, top, std::max({t.apex.x, t.left.x, t.right.x}) - left,
+                              std::max({t.apex.y, t.left.y, t.right.y}) - top});
+    }
+    for (const Rect& checkpoint : level.checkpoints) add(SpriteCheckpoint, checkpoint);
+    add(SpriteGoal, level.goal);
+}
+
+//-----------------------------------------
+void SpriteAtlas::draw(QPainter& painter, const SpriteBatch& batch) const {
+    if (batch.isEmpty()) return;
+
+    if (painter.device() && painter.device()->devType() == QInternal::Image) {
+        for (const QPainter::PixmapFragment& f : batch) {
+            const QRectF source(f.sourceLeft, f.sourceTop, f.width, f.height);
+            const QSizeF size(f.width * f.scaleX, f.height * f.scaleY);
+            painter.drawImage(QRectF(QPointF(f.x - size.width() / 2, f.y - size.height() / 2), size), image, source);
+        }
+        return;
+    }
+
+    if (pixmap.isNull()) pixmap = QPixmap::fromImage(image);
+    painter.drawPixmapFragments(batch.constData(), int(batch.size()), pixmap);
+}
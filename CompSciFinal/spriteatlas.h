@@ -0,0 +1,78 @@
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+// All the game's art in one image (a texture atlas), and the code that draws
+// the player and level from it. A whole level is drawn with one
+// drawPixmapFragments() call instead of one paint per item, so a bigger level
+// costs more pieces in one batch, not more items.
+//
+// The atlas image has this layout (pixels, x y w h). Each sprite is stretched
+// over the item's bounding box, 1px outline included:
+//
+//   player    0  0 21 21
+//   goal     21  0 31 31
+//   spike    52  0 21 11
+//   platform 73  0 12 12   nine-slice: the 3px border keeps its size and only
+//                          the middle stretches, so every platform length looks right
+//   checkpoint 85 0 11 21  (added later: an 85px wide atlas from before still
+//                          loads, and gets the built-in checkpoint flag)
+//
+// Without an atlas file the built-in one is used, which looks like the old
+// flat-coloured shapes.
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+#include "level.h"
+
+//-----------------------------------------
+enum Sprite {
+    SpritePlayer = 0,
+    SpriteGoal = 1,
+    SpriteSpike = 2,
+    SpritePlatform = 3,
+    SpriteCheckpoint = 4,
+    SpriteCount = 5,
+};
+
+namespace SpriteConfig {
+    constexpr int AtlasWidth = 96;     // Smallest image that holds the layout above
+    constexpr int OldAtlasWidth = 85;  // The layout before the checkpoint sprite
+    constexpr int AtlasHeight = 31;
+    constexpr int PlatformSlice = 3;   // Border of the platform sprite that does not stretch
+}
+
+using SpriteBatch = QVector<QPainter::PixmapFragment>;
+
+//-----------------------------------------
+class SpriteAtlas {
+public:
+    SpriteAtlas();   // The built-in art
+
+    // The atlas every painter uses unless it is given another one
+    static const SpriteAtlas& builtIn();
+
+    // Use the art in an image file with the layout above. Keeps the old art and
+    // returns false if the file can't be read or is too small.
+    bool load(const QString& path);
+
+    // Add the pieces that draw "sprite" over "target" (scene units) to "batch"
+    void addSprite(SpriteBatch& batch, Sprite sprite, const QRectF& target) const;
+
+    // Add the level's platforms, spikes, checkpoints and goal, skipping anything outside "visible"
+    void addLevel(SpriteBatch& batch, const LevelData& level, const QRectF& visible) const;
+
+    // Draw a batch. On screen this is one drawPixmapFragments() call. Pixmaps
+    // belong to the GUI thread, so into a QImage (which tools do on any thread)
+    // each piece is drawn from the atlas image instead.
+    void draw(QPainter& painter, const SpriteBatch& batch) const;
+
+private:
+    QImage image;
+    mutable QPixmap pixmap;   // Made from "image" the first time it is drawn on screen
+};
+
+#endif // SPRITEATLAS_H
@@ -0,0 +1,42 @@
+#include "startupprofile.h"
+
+#include <QElapsedTimer>
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+    // Started while the program is being loaded, before main() runs
+    struct StartClock {
+        QElapsedTimer timer;
+        StartClock() { timer.start(); }
+    };
+    StartClock& startClock() {
+        static StartClock clock;
+        return clock;
+    }
+    [[maybe_unused]] const StartClock& earlyStart = startClock();
+
+    struct Phase {
+        const char* name;
+        qint64 endNs;
+    };
+    std::vector<Phase> phases;
+}
+
+void StartupProfile::mark(const char* phase) {
+    phases.push_back(Phase{phase, elapsedNs()});
+}
+
+qint64 StartupProfile::elapsedNs() {
+    return startClock().timer.nsecsElapsed();
+}
+
+void StartupProfile::report() {
+    std::fprintf(stderr, "Startup profile:\n");
+    qint64 previous = 0;
+    for (const Phase& phase : phases) {
+        std::fprintf(stderr, "  %-28s %8.2f ms  (at %8.2f ms)\n", phase.name, (phase.endNs - previous) / 1e6, phase.endNs / 1e6);
+        previous = phase.endNs;
+    }
+}
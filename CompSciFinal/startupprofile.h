@@ -0,0 +1,19 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+// Measures how long startup takes, from the program starting until the first
+// frame of the game is on screen, split into named phases.
+#include <QtGlobal>
+
+namespace StartupProfile {
+    // Record that a phase just finished (call these in order, on the GUI thread)
+    void mark(const char* phase);
+
+    // Nanoseconds since the program started
+    qint64 elapsedNs();
+
+    // Print every phase and how long it took to stderr
+    void report();
+}
+
+#endif // STARTUPPROFILE_H
@@ -0,0 +1,65 @@
+#include "terrain.h"
+
+#include <vector>
+
+using namespace TerrainConfig;
+
+//-----------------------------------------
+// A random value for every whole number (the lattice points of the noise).
+// Only 32-bit multiplies and shifts, which SIMD units have.
+static inline uint32_t hash32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Value noise: random heights at whole numbers, smoothly blended in between.
+// There are no branches in the loop body, so it vectorizes.
+static void valueNoise(uint32_t seed, float x, float step, int count, float amplitude, float* out) {
+    for (int i = 0; i < count; ++i) {
+        const float p = x + step * float(i);
+        const float cell = std::floor(p);
+        const float t = p - cell;
+        const uint32_t n = uint32_t(int32_t(cell));
+        const float a = float(hash32(n ^ seed) >> 8) * (1.0f / 16777216.0f);
+        const float b = float(hash32((n + 1) ^ seed) >> 8) * (1.0f / 16777216.0f);
+        const float s = t * t * (3.0f - 2.0f * t);   // Smoothstep, so the slopes join up
+        out[i] += amplitude * (a + (b - a) * s);
+    }
+}
+
+void fractalNoise(uint32_t seed, float x, float step, int count, float* out) {
+    std::fill(out, out + count, 0.0f);
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    for (int octave = 0; octave < Octaves; ++octave) {
+        valueNoise(hash32(seed + uint32_t(octave)), x, step, count, amplitude, out);
+        total += amplitude;
+        x *= 2.0f;
+        step *= 2.0f;
+        amplitude *= 0.5f;
+    }
+    for (int i = 0; i < count; ++i) out[i] /= total;
+}
+
+//-----------------------------------------
+void addTerrain(LevelData& level, uint64_t seed) {
+    const Rect& b = level.bounds;
+    const int columns = std::max(1, int(std::ceil(b.w / ColumnWidth)));
+    std::vector<float> noise(size_t(columns), 0.0f);
+    fractalNoise(uint32_t(seed ^ (seed >> 32)), 0.0f, float(ColumnWidth / Wavelength), columns, noise.data());
+
+    level.terrain.resize(size_t(columns));
+    const double spawnMiddle = level.spawn.x + LevelConfig::PlayerSize / 2;
+    for (int c = 0; c < columns; ++c) {
+        // Flat at the spawn point (the player always respawns there), rising
+        // smoothly to full height a little further out
+        const double middle = b.x + (c + 0.5) * ColumnWidth;
+        const double distance = std::abs(middle - spawnMiddle) - FlatAroundSpawn;
+        const double fade = std::clamp(distance / FlatAroundSpawn, 0.0, 1.0);
+        level.terrain[size_t(c)] = float(b.bottom() - Amplitude * fade * noise[size_t(c)]);
+    }
+}
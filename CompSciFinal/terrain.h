@@ -0,0 +1,46 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+// Rolling ground for levels. The ground is a heightfield: one height for every
+// few pixels across the scene, made from smooth noise. Levels without terrain
+// keep the old flat floor at the bottom of the scene.
+//
+// Collision only needs the few columns under the player, so it costs the same
+// however wide the level is, and drawing uses one cached image per level
+// instead of thousands of items.
+#include "level.h"
+
+#include <algorithm>
+#include <cmath>
+
+//-----------------------------------------
+namespace TerrainConfig {
+    constexpr double ColumnWidth = 4;     // Scene pixels per height sample
+    constexpr double Amplitude = 35;      // Highest hill above the bottom of the scene
+    constexpr double Wavelength = 240;    // Size of the largest hills
+    constexpr int Octaves = 3;            // Smaller bumps on top, each half the size
+    constexpr double FlatAroundSpawn = 60; // The ground under the spawn point stays flat
+}
+
+// Fill level.terrain with rolling ground for this level
+void addTerrain(LevelData& level, uint64_t seed);
+
+// Smooth 1D noise in [0, 1] for "count" points starting at "x" and "step" apart
+// (value noise with several octaves). Written as plain loops over arrays so the
+// compiler turns them into SIMD code.
+void fractalNoise(uint32_t seed, float x, float step, int count, float* out);
+
+//-----------------------------------------
+// The top of the ground under a player standing at x with the given width:
+// the highest column it overlaps. This runs every tick.
+inline double groundTop(const LevelData& level, double x, double width) {
+    if (level.terrain.empty()) return level.bounds.bottom();
+    const int last = int(level.terrain.size()) - 1;
+    const int first = std::clamp(int(std::floor((x - level.bounds.x) / TerrainConfig::ColumnWidth)), 0, last);
+    const int end = std::clamp(int(std::floor((x + width - level.bounds.x) / TerrainConfig::ColumnWidth)), first, last);
+    float top = level.terrain[size_t(first)];
+    for (int c = first + 1; c <= end; ++c) top = std::min(top, level.terrain[size_t(c)]);
+    return top;
+}
+
+#endif // TERRAIN_H
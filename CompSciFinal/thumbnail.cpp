@@ -0,0 +1,105 @@
+#include "thumbnail.h"
+
+#include "terrain.h"
+
+#include <algorithm>
+#include <cmath>
+
+//-----------------------------------------
+// A tiny canvas: the pixels plus the scale from scene pixels to thumbnail pixels
+struct Canvas {
+    uint32_t* pixels;
+    int width;
+    int height;
+    int stride;
+    double scaleX;
+    double scaleY;
+
+    // Pixel columns/rows covered by [from, to) in scene units, always at least one
+    void span(double from, double to, double scale, int limit, int& first, int& last) const {
+        first = std::clamp(int(std::floor(from * scale)), 0, limit - 1);
+        last = std::clamp(int(std::ceil(to * scale)), first + 1, limit);
+    }
+
+    void fillRect(const Rect& r, uint32_t color) {
+        int x0, x1, y0, y1;
+        span(r.left(), r.right(), scaleX, width, x0, x1);
+        span(r.top(), r.bottom(), scaleY, height, y0, y1);
+        for (int y = y0; y < y1; ++y) std::fill(pixels + y * stride + x0, pixels + y * stride + x1, color);
+    }
+
+    void fillTriangle(const Triangle& t, uint32_t color) {
+        const Vec2 a{t.apex.x * scaleX, t.apex.y * scaleY};
+        const Vec2 b{t.left.x * scaleX, t.left.y * scaleY};
+        const Vec2 c{t.right.x * scaleX, t.right.y * scaleY};
+        int x0, x1, y0, y1;
+        span(std::min({t.apex.x, t.left.x, t.right.x}), std::max({t.apex.x, t.left.x, t.right.x}), scaleX, width, x0, x1);
+        span(std::min({t.apex.y, t.left.y, t.right.y}), std::max({t.apex.y, t.left.y, t.right.y}), scaleY, height, y0, y1);
+
+        // Which side of edge p->q the point is on
+        auto edge = [](const Vec2& p, const Vec2& q, double x, double y) {
+            return (q.x - p.x) * (y - p.y) - (q.y - p.y) * (x - p.x);
+        };
+
+        bool drewAny = false;
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                const double px = x + 0.5, py = y + 0.5;   // Test the pixel centre
+                const double e0 = edge(a, b, px, py), e1 = edge(b, c, px, py), e2 = edge(c, a, px, py);
+                if ((e0 >= 0 && e1 >= 0 && e2 >= 0) || (e0 <= 0 && e1 <= 0 && e2 <= 0)) {
+                    pixels[y * stride + x] = color;
+                    drewAny = true;
+                }
+            }
+        }
+
+        // Very small spikes still get one pixel so they stay visible
+        if (!drewAny) pixels[y0 * stride + x0] = color;
+    }
+
+    void fillEllipse(const Rect& r, uint32_t color) {
+        int x0, x1, y0, y1;
+        span(r.left(), r.right(), scaleX, width, x0, x1);
+        span(r.top(), r.bottom(), scaleY, height, y0, y1);
+        const double cx = (r.x + r.w / 2) * scaleX, cy = (r.y + r.h / 2) * scaleY;
+        const double rx = std::max(0.5, r.w / 2 * scaleX), ry = std::max(0.5, r.h / 2 * scaleY);
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                const double dx = (x + 0.5 - cx) / rx, dy = (y + 0.5 - cy) / ry;
+                if (dx * dx + dy * dy <= 1.0) pixels[y * stride + x] = color;
+            }
+        }
+    }
+
+    // Every pixel column down from the highest ground under it, the same
+    // ground the player stands on
+    void fillTerrain(const LevelData& level, uint32_t color) {
+        if (level.terrain.empty()) return;
+        for (int x = 0; x < width; ++x) {
+            const double top = groundTop(level, x / scaleX, 1 / scaleX);
+            int y0, y1;
+            span(top, level.bounds.bottom(), scaleY, height, y0, y1);
+            for (int y = y0; y < y1; ++y) pixels[y * stride + x] = color;
+        }
+    }
+};
+
+//-----------------------------------------
+// Draw in the same order as the game: background, spawn (player), then the level
+void rasterizeThumbnail(const LevelData& level, uint32_t* pixels, int width, int height, int stride) {
+    Canvas canvas{pixels, width, height, stride, width / level.bounds.w, height / level.bounds.h};
+
+    for (int y = 0; y < height; ++y) std::fill(pixels + y * stride, pixels + y * stride + width, ThumbnailColors::Background);
+
+    canvas.fillTerrain(level, ThumbnailColors::Ground);
+    canvas.fillRect(Rect{level.spawn.x, level.spawn.y, LevelConfig::PlayerSize, LevelConfig::PlayerSize}, ThumbnailColors::Spawn);
+    for (const Rect& platform : level.platforms) canvas.fillRect(platform, ThumbnailColors::Platform);
+    for (const Triangle& spike : level.spikes) canvas.fillTriangle(spike, ThumbnailColors::Spike);
+    for (const Rect& checkpoint : level.checkpoints) canvas.fillRect(checkpoint, ThumbnailColors::Checkpoint);
+    canvas.fillEllipse(level.goal, ThumbnailColors::Goal);
+}
+
+void rasterizeTerrain(const LevelData& level, uint32_t* pixels, int width, int height, int stride, uint32_t color) {
+    Canvas canvas{pixels, width, height, stride, width / level.bounds.w, height / level.bounds.h};
+    canvas.fillTerrain(level, color);
+}
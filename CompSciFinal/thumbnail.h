@@ -0,0 +1,31 @@
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+// Draws a small preview of a level straight into a block of pixels.
+// No QPainter or scene is used, so thousands of previews can be drawn
+// quickly, and on many threads at once (each into its own pixels).
+#include "level.h"
+
+#include <cstdint>
+
+//-----------------------------------------
+// Colours in 0xAARRGGBB, the same layout as QImage::Format_ARGB32 / QRgb
+namespace ThumbnailColors {
+    constexpr uint32_t Background = 0xFFADD8E6;  // QColor(173, 216, 230)
+    constexpr uint32_t Platform = 0xFF808080;    // Qt::darkGray
+    constexpr uint32_t Spike = 0xFFFF0000;       // Qt::red
+    constexpr uint32_t Goal = 0xFFFFFF00;        // Qt::yellow
+    constexpr uint32_t Spawn = 0xFF0000FF;       // Qt::blue (the player)
+    constexpr uint32_t Ground = 0xFF556B2F;      // QColor(85, 107, 47), the hills
+    constexpr uint32_t Checkpoint = 0xFF00FF00;  // Qt::green
+}
+
+// Draw "level" scaled to fit a width x height area starting at "pixels".
+// "stride" is the number of pixels from one row to the next.
+void rasterizeThumbnail(const LevelData& level, uint32_t* pixels, int width, int height, int stride);
+
+// Draw only the level's terrain (if it has any), leaving the other pixels alone.
+// The game and the frame painter draw this once per level into a cached image.
+void rasterizeTerrain(const LevelData& level, uint32_t* pixels, int width, int height, int stride, uint32_t color);
+
+#endif // THUMBNAIL_H
@@ -0,0 +1,215 @@
+// engine_bench: times the headless engine on recorded runs and generated seeds.
+//
+//   engine_bench runs/ --seeds 200 --ticks 5000
+//   engine_bench --generator hills
+//
+// It measures level generation, replaying recorded runs, and playing generated
+// seeds with a fixed pseudo-random input stream (generated levels use
+// --generator, classic by default; replays bring their own). On Linux each test also
+// reports hardware counters per operation (cycles, instructions, L1/LLC misses,
+// branch misses), so layout changes can be judged by cache behaviour and not
+// just by the clock. The last line is meant for scripts (the PGO build reads it):
+//   RESULT generate_ns=... replay_step_ns=... seed_step_ns=... checksum=...
+// The checksum only depends on the game rules, so two builds of the same code
+// must print the same one.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "level.h"
+#include "perfcounters.h"
+#include "replay.h"
+#include "simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double nanosecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Mix a value into a running checksum
+static void mix(uint64_t& sum, uint64_t value) {
+    sum = (sum ^ value) * 0x100000001B3ull;
+}
+
+//-----------------------------------------
+// One timed test: its best round and the hardware counters from that round
+struct Section {
+    const char* name;
+    const char* unit;                 // What one operation is ("step", "level")
+    double bestNs = 0;
+    uint64_t ops = 0;
+    std::vector<PerfCounters::Reading> counters{};
+
+    double bestNsPerOp() const { return ops ? bestNs / double(ops) : 0.0; }
+};
+
+// Run "work" once, timing it and (if asked) counting hardware events.
+// "work" returns how many operations it did.
+template <typename Work>
+static void measure(Section& section, PerfCounters& perf, bool usePerf, Work work) {
+    if (usePerf) perf.start();
+    const auto start = Clock::now();
+    const uint64_t ops = work();
+    const double ns = nanosecondsSince(start);
+    if (usePerf) perf.stop();
+
+    if (ops == 0) return;
+    if (section.ops == 0 || ns / double(ops) < section.bestNsPerOp()) {
+        section.bestNs = ns;
+        section.ops = ops;
+        section.counters = usePerf ? perf.read() : std::vector<PerfCounters::Reading>();
+    }
+}
+
+static void printSection(const Section& section) {
+    if (section.ops == 0) {
+        std::printf("%-17s:        n/a\n", section.name);
+        return;
+    }
+    std::printf("%-17s: %10.1f ns/%-5s (%llu ops)\n", section.name, section.bestNsPerOp(), section.unit,
+                (unsigned long long)section.ops);
+
+    // Counters per operation, plus instructions per cycle when we have both
+    double cycles = 0, instructions = 0;
+    for (const PerfCounters::Reading& r : section.counters) {
+        std::printf("    %-14s %12.2f per %s\n", r.name, r.value / double(section.ops), section.unit);
+        if (!std::strcmp(r.name, "cycles")) cycles = r.value;
+        if (!std::strcmp(r.name, "instructions")) instructions = r.value;
+    }
+    if (cycles > 0 && instructions > 0) std::printf("    %-14s %12.2f\n", "ipc", instructions / cycles);
+}
+
+static void printUsage() {
+    std::printf("usage: engine_bench [replays or folders...] [--seeds N] [--ticks N] [--levels N] [--repeat N] [--no-perf]\n"
+                "                    [--generator classic|path|chunks|hills]\n");
+}
+
+//-----------------------------------------
+int main(int argc, char* argv[]) {
+    int seedCount = 200;      // Seeds to generate and play
+    int ticksPerSeed = 5000;  // Ticks played on each seed
+    int levelsPerSeed = 10;   // Levels generated per seed in the generation test
+    int repeat = 3;           // Each test runs this many times, the fastest counts
+    bool usePerf = true;      // Read hardware counters when the system allows it
+    LevelGenerator generator = LevelGenerator::Classic;   // For the generated seeds
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto value = [&]() {
+            if (i + 1 >= argc) {
+                printUsage();
+                std::exit(1);
+            }
+            return std::max(0, std::atoi(argv[++i]));
+        };
+        if (!std::strcmp(arg, "--seeds")) seedCount = value();
+        else if (!std::strcmp(arg, "--ticks")) ticksPerSeed = value();
+        else if (!std::strcmp(arg, "--levels")) levelsPerSeed = value();
+        else if (!std::strcmp(arg, "--repeat")) repeat = std::max(1, value());
+        else if (!std::strcmp(arg, "--no-perf")) usePerf = false;
+        else if (!std::strcmp(arg, "--generator")) {
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            if (!parseGenerator(argv[++i], generator)) {
+                std::fprintf(stderr, "Unknown level generator %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!std::strcmp(arg, "--help") || !std::strcmp(arg, "-h")) {
+            printUsage();
+            return 0;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    // Load every replay up front so file reading is not timed
+    std::vector<Replay> replays;
+    for (const std::string& path : paths) {
+        std::vector<std::string> files;
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path))
+                if (entry.path().extension() == ".replay") files.push_back(entry.path().string());
+            std::sort(files.begin(), files.end());
+        } else {
+            files.push_back(path);
+        }
+        for (const std::string& file : files) {
+            Replay replay;
+            if (loadReplay(file, replay)) replays.push_back(std::move(replay));
+            else std::fprintf(stderr, "Skipping unreadable replay %s\n", file.c_str());
+        }
+    }
+
+    const Rect bounds = worldBounds();
+    PerfCounters perf;
+    if (!usePerf) std::printf("hardware counters: off\n");
+    else if (!perf.available()) std::printf("hardware counters: not available (perf_event_open refused)\n");
+
+    // Each test keeps its fastest round, along with that round's counters
+    Section generate{"level generation", "level"};
+    Section replaying{"replay stepping", "step"};
+    Section seeded{"seed stepping", "step"};
+    uint64_t checksum = 0;
+
+    for (int round = 0; round < repeat; ++round) {
+        uint64_t sum = 0xCBF29CE484222325ull;
+
+        // 1. Level generation
+        measure(generate, perf, usePerf, [&]() {
+            for (int s = 1; s <= seedCount; ++s) {
+                for (int level = 1; level <= levelsPerSeed; ++level) {
+                    const LevelData data = generateLevelData(uint64_t(s), level, bounds, generator);
+                    mix(sum, data.platforms.size() * 31 + data.spikes.size());
+                }
+            }
+            return uint64_t(seedCount) * uint64_t(levelsPerSeed);
+        });
+
+        // 2. Recorded runs
+        measure(replaying, perf, usePerf, [&]() {
+            uint64_t steps = 0;
+            for (const Replay& replay : replays) {
+                Simulation sim(replay.seed, Rect{0, 0, replay.width, replay.height}, replay.generator);
+                for (uint8_t input : replay.inputs) sim.step(input);
+                steps += replay.inputs.size();
+                mix(sum, uint64_t(sim.state().level) << 32 | uint32_t(sim.state().deaths));
+            }
+            return steps;
+        });
+
+        // 3. Generated seeds with a fixed input stream (held keys, like a player)
+        measure(seeded, perf, usePerf, [&]() {
+            for (int s = 1; s <= seedCount; ++s) {
+                Simulation sim(uint64_t(s), bounds, generator);
+                Rng inputs(uint64_t(s) * 7919);
+                uint8_t input = 0;
+                for (int t = 0; t < ticksPerSeed; ++t) {
+                    if (t % 12 == 0) input = uint8_t(inputs.bounded(0, 8));
+                    sim.step(input);
+                    if (sim.gameOver()) sim = Simulation(uint64_t(s) + uint64_t(t) * 1000003ull, bounds, generator);
+                }
+                mix(sum, uint64_t(sim.state().level) << 32 | uint32_t(sim.state().tick));
+            }
+            return uint64_t(seedCount) * uint64_t(ticksPerSeed);
+        });
+
+        checksum = sum;
+    }
+
+    printSection(generate);
+    printSection(replaying);
+    printSection(seeded);
+    std::printf("RESULT generate_ns=%.2f replay_step_ns=%.2f seed_step_ns=%.2f checksum=%016llx\n",
+                generate.bestNsPerOp(), replaying.bestNsPerOp(), seeded.bestNsPerOp(), (unsigned long long)checksum);
+    return 0;
+}
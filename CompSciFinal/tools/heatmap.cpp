@@ -0,0 +1,270 @@
+// heatmap: replays many recorded runs and counts where players go and where they die.
+//
+//   heatmap out/ runs/*.replay
+//   heatmap out/ runs/ --cell 5
+//
+// For every level layout (seed, generator, scene size and level) it writes
+// <seed>_<generator>_<width>x<height>_<level>_visits.png and ..._deaths.png
+// (heat drawn over a preview of the level), and one heatmap.csv with the raw
+// counts for every grid cell that was touched.
+// Each thread counts into its own histograms; they are merged at the end.
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "replay.h"
+#include "simulation.h"
+#include "thumbnail.h"
+
+//-----------------------------------------
+// Counts for one level layout, one number per grid cell
+struct Histogram {
+    int gridW = 0;                  // Grid size in cells
+    int gridH = 0;
+    std::vector<quint32> visits;
+    std::vector<quint32> deaths;
+};
+
+// Everything that decides a level's layout: the run seed, the generator, the
+// scene size and the level number. Runs only share a histogram if all of them match.
+struct LevelKey {
+    quint64 seed;
+    LevelGenerator generator;
+    double width;
+    double height;
+    int level;
+
+    bool operator<(const LevelKey& other) const {
+        return std::tie(seed, generator, width, height, level) <
+               std::tie(other.seed, other.generator, other.width, other.height, other.level);
+    }
+};
+using HistogramMap = std::map<LevelKey, Histogram>;
+
+// Add every count of "from" into "into". The key fixes the scene size and so
+// the grid size, so two histograms of different sizes under one key are a bug:
+// false is returned instead of dropping their counts.
+static bool mergeInto(HistogramMap& into, HistogramMap& from) {
+    bool ok = true;
+    for (auto& entry : from) {
+        auto found = into.find(entry.first);
+        if (found == into.end()) {
+            into.emplace(entry.first, std::move(entry.second));
+            continue;
+        }
+        Histogram& target = found->second;
+        if (target.visits.size() != entry.second.visits.size()) {
+            ok = false;
+            continue;
+        }
+        for (size_t i = 0; i < target.visits.size(); ++i) {
+            target.visits[i] += entry.second.visits[i];
+            target.deaths[i] += entry.second.deaths[i];
+        }
+    }
+    from.clear();
+    return ok;
+}
+
+//-----------------------------------------
+// A black -> red -> yellow -> white colour ramp, blended mostly opaque over the level
+static QRgb heatColor(double t) {
+    t = std::clamp(t, 0.0, 1.0);
+    const int r = int(255 * std::min(1.0, t * 3));
+    const int g = int(255 * std::clamp(t * 3 - 1, 0.0, 1.0));
+    const int b = int(255 * std::clamp(t * 3 - 2, 0.0, 1.0));
+    return qRgb(r, g, b);
+}
+
+static QImage heatImage(const LevelData& level, const std::vector<quint32>& counts, int gridW, int gridH, int zoom) {
+    QImage image(gridW * zoom, gridH * zoom, QImage::Format_ARGB32);
+    rasterizeThumbnail(level, reinterpret_cast<uint32_t*>(image.bits()), image.width(), image.height(),
+                       int(image.bytesPerLine() / 4));
+
+    // Log scale so a few very busy cells don't hide everything else
+    const quint32 most = counts.empty() ? 0 : *std::max_element(counts.begin(), counts.end());
+    if (most == 0) return image;
+    const double scale = 1.0 / std::log1p(double(most));
+
+    for (int gy = 0; gy < gridH; ++gy) {
+        for (int gx = 0; gx < gridW; ++gx) {
+            const quint32 count = counts[gy * gridW + gx];
+            if (count == 0) continue;
+            const QRgb heat = heatColor(std::log1p(double(count)) * scale);
+            for (int y = gy * zoom; y < (gy + 1) * zoom; ++y) {
+                QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+                for (int x = gx * zoom; x < (gx + 1) * zoom; ++x) {
+                    const QRgb under = line[x];
+                    line[x] = qRgb((qRed(under) + 3 * qRed(heat)) / 4, (qGreen(under) + 3 * qGreen(heat)) / 4,
+                                   (qBlue(under) + 3 * qBlue(heat)) / 4);
+                }
+            }
+        }
+    }
+    return image;
+}
+
+//-----------------------------------------
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Build player position and spike death heatmaps from recorded runs.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Folder for the images and heatmap.csv.");
+    parser.addPositionalArgument("replays", "Replay files, or folders of *.replay files.", "[replays...]");
+    QCommandLineOption cellOption("cell", "Grid cell size in scene pixels.", "px", "10");
+    QCommandLineOption zoomOption("zoom", "Image pixels per grid cell.", "px", "4");
+    QCommandLineOption threadsOption("threads", "Number of worker threads.", "n",
+                                     QString::number(std::max(1u, std::thread::hardware_concurrency())));
+    parser.addOptions({cellOption, zoomOption, threadsOption});
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.size() < 2) parser.showHelp(1);
+    const QString output = args.takeFirst();
+
+    // Expand folders into the replay files they hold
+    QStringList files;
+    for (const QString& arg : args) {
+        QFileInfo info(arg);
+        if (info.isDir()) {
+            for (const QFileInfo& entry : QDir(arg).entryInfoList({"*.replay"}, QDir::Files, QDir::Name))
+                files << entry.filePath();
+        } else {
+            files << arg;
+        }
+    }
+
+    const int cell = std::max(1, parser.value(cellOption).toInt());
+    const int zoom = std::max(1, parser.value(zoomOption).toInt());
+    const int threadCount = std::max(1, parser.value(threadsOption).toInt());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Every thread replays the next file and counts into its own map, so there is no locking
+    std::vector<HistogramMap> partials(threadCount);
+    std::atomic<int> nextFile{0};
+    std::atomic<int> unreadable{0};
+    std::atomic<qint64> ticksPlayed{0};
+
+    auto worker = [&](HistogramMap& histograms) {
+        for (int f = nextFile++; f < files.size(); f = nextFile++) {
+            Replay replay;
+            if (!loadReplay(files[f].toStdString(), replay)) {
+                unreadable++;
+                continue;
+            }
+
+            const int gridW = int(std::ceil(replay.width / cell));
+            const int gridH = int(std::ceil(replay.height / cell));
+            auto cellIndex = [&](double x, double y) {
+                // Count the centre of the player square
+                const int gx = std::clamp(int((x + LevelConfig::PlayerSize / 2) / cell), 0, gridW - 1);
+                const int gy = std::clamp(int((y + LevelConfig::PlayerSize / 2) / cell), 0, gridH - 1);
+                return gy * gridW + gx;
+            };
+            auto histogramFor = [&](int levelIndex) -> Histogram& {
+                Histogram& h = histograms[LevelKey{replay.seed, replay.generator, replay.width, replay.height, levelIndex}];
+                if (h.visits.empty()) {
+                    h.gridW = gridW;
+                    h.gridH = gridH;
+                    h.visits.assign(size_t(gridW) * gridH, 0);
+                    h.deaths.assign(size_t(gridW) * gridH, 0);
+                }
+                return h;
+            };
+
+            Simulation sim(replay.seed, Rect{0, 0, replay.width, replay.height}, replay.generator);
+            for (quint8 input : replay.inputs) {
+                if (sim.gameOver()) break;
+                const uint8_t events = sim.step(input);
+
+                // A spike death is counted where it happened, not at the respawn point
+                if (events & StepDied) {
+                    const Vec2 at = sim.lastDeathPos();
+                    histogramFor(sim.state().level).deaths[cellIndex(at.x, at.y)]++;
+                }
+                histogramFor(sim.state().level).visits[cellIndex(sim.state().x, sim.state().y)]++;
+            }
+            ticksPlayed += sim.state().tick;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) threads.emplace_back(worker, std::ref(partials[i]));
+    for (std::thread& t : threads) t.join();
+
+    // Parallel reduction: merge pairs of maps at the same time until one is left
+    std::atomic<bool> mismatch{false};
+    for (int stride = 1; stride < threadCount; stride *= 2) {
+        std::vector<std::thread> mergers;
+        for (int i = 0; i + stride < threadCount; i += 2 * stride)
+            mergers.emplace_back([&, i, stride]() {
+                if (!mergeInto(partials[i], partials[i + stride])) mismatch = true;
+            });
+        for (std::thread& t : mergers) t.join();
+    }
+    if (mismatch) {
+        std::fprintf(stderr, "Histograms of the same level had different grid sizes\n");
+        return 1;
+    }
+    const HistogramMap& result = partials[0];
+
+    // Write the images and the CSV
+    QDir().mkpath(output);
+    QFile csvFile(QDir(output).filePath("heatmap.csv"));
+    if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        std::fprintf(stderr, "Could not write %s\n", qPrintable(csvFile.fileName()));
+        return 1;
+    }
+    QTextStream csv(&csvFile);
+    csv << "seed,generator,width,height,level,cell_x,cell_y,scene_x,scene_y,visits,deaths\n";
+
+    for (const auto& entry : result) {
+        const LevelKey& key = entry.first;
+        const Histogram& h = entry.second;
+
+        const int gridW = h.gridW;
+        const int gridH = h.gridH;
+        const LevelData level = generateLevelData(key.seed, key.level, Rect{0, 0, key.width, key.height}, key.generator);
+
+        const QString base = QDir(output).filePath(QString("%1_%2_%3x%4_%5")
+                                                       .arg(key.seed)
+                                                       .arg(generatorName(key.generator))
+                                                       .arg(key.width)
+                                                       .arg(key.height)
+                                                       .arg(key.level));
+        heatImage(level, h.visits, gridW, gridH, zoom).save(base + "_visits.png");
+        heatImage(level, h.deaths, gridW, gridH, zoom).save(base + "_deaths.png");
+
+        for (int i = 0; i < int(h.visits.size()); ++i) {
+            if (!h.visits[i] && !h.deaths[i]) continue;
+            csv << key.seed << ',' << generatorName(key.generator) << ',' << key.width << ',' << key.height << ','
+                << key.level << ',' << i % gridW << ',' << i / gridW << ','
+                << (i % gridW) * cell << ',' << (i / gridW) * cell << ',' << h.visits[i] << ',' << h.deaths[i] << '\n';
+        }
+    }
+
+    if (unreadable > 0) std::fprintf(stderr, "Skipped %d unreadable replay files\n", int(unreadable));
+    std::printf("Replayed %d runs (%lld ticks) into %d level heatmaps in %.2fs on %d threads\n",
+                int(files.size()) - int(unreadable), (long long)ticksPlayed, int(result.size()),
+                timer.elapsed() / 1000.0, threadCount);
+    return 0;
+}
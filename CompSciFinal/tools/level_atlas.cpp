@@ -0,0 +1,145 @@
+// level_atlas: draws a small preview of many seeds' levels into packed atlas images.
+//
+//   level_atlas atlas --first 1 --count 5000
+//   level_atlas atlas --seeds seeds.txt --level 3
+//   level_atlas atlas --count 500 --generator chunks
+//
+// Writes atlas_0.png, atlas_1.png, ... (as many pages as needed) and atlas.csv,
+// which says where each seed's preview is. Levels are built with
+// generateLevelData() and drawn straight into the page's pixels, no scene.
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "level.h"
+#include "thumbnail.h"
+
+//-----------------------------------------
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Build preview atlases for a range or list of level seeds.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Output name; writes <output>_N.png and <output>.csv.");
+    QCommandLineOption firstOption("first", "First seed of the range.", "seed", "1");
+    QCommandLineOption countOption("count", "Number of seeds in the range.", "n", "1000");
+    QCommandLineOption seedsOption("seeds", "Read seeds from <file> (one per line) instead of a range.", "file");
+    QCommandLineOption levelOption("level", "Which level of each seed to preview.", "level", "1");
+    QCommandLineOption generatorOption("generator", "Level generator: classic, path, chunks or hills.", "name", "classic");
+    QCommandLineOption widthOption("width", "Preview width in pixels.", "px", "100");
+    QCommandLineOption heightOption("height", "Preview height in pixels.", "px", "50");
+    QCommandLineOption pageOption("page", "Largest atlas page side in pixels.", "px", "4096");
+    QCommandLineOption threadsOption("threads", "Number of worker threads.", "n",
+                                     QString::number(std::max(1u, std::thread::hardware_concurrency())));
+    parser.addOptions({firstOption, countOption, seedsOption, levelOption, generatorOption, widthOption, heightOption, pageOption, threadsOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) parser.showHelp(1);
+    const QString output = parser.positionalArguments().first();
+
+    // Collect the seeds to draw
+    std::vector<quint64> seeds;
+    if (parser.isSet(seedsOption)) {
+        QFile file(parser.value(seedsOption));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            std::fprintf(stderr, "Could not read %s\n", qPrintable(file.fileName()));
+            return 1;
+        }
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            bool ok = false;
+            const quint64 seed = in.readLine().trimmed().toULongLong(&ok);
+            if (ok) seeds.push_back(seed);
+        }
+    } else {
+        const quint64 first = parser.value(firstOption).toULongLong();
+        const int count = std::max(0, parser.value(countOption).toInt());
+        for (int i = 0; i < count; ++i) seeds.push_back(first + quint64(i));
+    }
+
+    const int levelIndex = std::max(0, parser.value(levelOption).toInt());
+    LevelGenerator generator = LevelGenerator::Classic;
+    if (!parseGenerator(parser.value(generatorOption).toStdString(), generator)) {
+        std::fprintf(stderr, "Unknown level generator %s\n", qPrintable(parser.value(generatorOption)));
+        return 1;
+    }
+    const int thumbW = std::max(1, parser.value(widthOption).toInt());
+    const int thumbH = std::max(1, parser.value(heightOption).toInt());
+    const int pageSide = std::max(std::max(thumbW, thumbH), parser.value(pageOption).toInt());
+    const int threadCount = std::max(1, parser.value(threadsOption).toInt());
+    const Rect bounds = worldBounds();
+
+    // How many previews fit on one page
+    const int columns = pageSide / thumbW;
+    const int rowsPerPage = pageSide / thumbH;
+    const int perPage = columns * rowsPerPage;
+
+    // Platform/spike counts for the index, filled in by the workers
+    std::vector<int> platformCounts(seeds.size()), spikeCounts(seeds.size());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Fill one page at a time so memory stays at one page no matter how many seeds there are
+    const int total = int(seeds.size());
+    for (int pageStart = 0, page = 0; pageStart < total; pageStart += perPage, ++page) {
+        const int onPage = std::min(perPage, total - pageStart);
+        const int rows = (onPage + columns - 1) / columns;
+        QImage atlas(std::min(onPage, columns) * thumbW, rows * thumbH, QImage::Format_ARGB32);
+        atlas.fill(Qt::transparent);
+
+        // Each cell is separate memory, so threads can draw into the same image safely
+        uint32_t* pixels = reinterpret_cast<uint32_t*>(atlas.bits());
+        const int stride = int(atlas.bytesPerLine() / 4);
+        std::atomic<int> next{0};
+        auto worker = [&]() {
+            for (int cell = next++; cell < onPage; cell = next++) {
+                const int index = pageStart + cell;
+                const LevelData level = generateLevelData(seeds[index], levelIndex, bounds, generator);
+                platformCounts[index] = int(level.platforms.size());
+                spikeCounts[index] = int(level.spikes.size());
+
+                uint32_t* origin = pixels + (cell / columns) * thumbH * stride + (cell % columns) * thumbW;
+                rasterizeThumbnail(level, origin, thumbW, thumbH, stride);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; ++i) threads.emplace_back(worker);
+        for (std::thread& t : threads) t.join();
+
+        const QString pageName = QString("%1_%2.png").arg(output).arg(page);
+        if (!atlas.save(pageName)) {
+            std::fprintf(stderr, "Could not write %s\n", qPrintable(pageName));
+            return 1;
+        }
+    }
+
+    // The index: where each seed's preview is and a little about its level
+    QFile indexFile(output + ".csv");
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        std::fprintf(stderr, "Could not write %s\n", qPrintable(indexFile.fileName()));
+        return 1;
+    }
+    QTextStream index(&indexFile);
+    index << "seed,level,page,x,y,width,height,platforms,spikes\n";
+    for (int i = 0; i < total; ++i) {
+        const int cell = i % perPage;
+        index << seeds[i] << ',' << levelIndex << ',' << i / perPage << ','
+              << (cell % columns) * thumbW << ',' << (cell / columns) * thumbH << ','
+              << thumbW << ',' << thumbH << ',' << platformCounts[i] << ',' << spikeCounts[i] << '\n';
+    }
+
+    std::printf("Drew %d previews in %.2fs on %d threads\n", total, timer.elapsed() / 1000.0, threadCount);
+    return 0;
+}
@@ -0,0 +1,273 @@
+// neuro_train: evolves NeuralBot networks on the headless engine.
+//
+//   neuro_train --population 2000 --generations 200 --out brains/
+//   neuro_train --resume brains/ --generations 50 --out brains/
+//
+// Every generation, each genome plays the same batch of freshly generated seeds
+// (so a network cannot just memorise one level). Genomes are scored on levels won,
+// how close they got to the next goal and how few lives they lost. The best ones
+// are kept unchanged, and the rest of the next generation are their children:
+// weights mixed from two parents picked by tournament, plus a little noise.
+// The best genomes are written to --out every few generations (elite_00.genome is
+// the very best), and --resume starts again from those files.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "level.h"
+#include "neuralbot.h"
+#include "simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct TrainSettings {
+    int population = 2000;
+    int generations = 100;
+    int seedsPerGeneration = 8;   // Seeds every genome plays each generation
+    int ticks = 1500;             // Ticks per seed (25 s of play)
+    int elite = 20;               // Copied unchanged into the next generation
+    double mutationRate = 0.05;   // Chance of each weight getting noise
+    double mutationSize = 0.3;    // Standard deviation of that noise
+    int checkpointEvery = 10;
+    LevelGenerator generator = LevelGenerator::Classic;   // Which kind of levels to train on
+    int threads = 1;
+    uint64_t trainSeed = 1;
+    std::string outDir = "brains";
+    std::string resumeDir;
+};
+
+//-----------------------------------------
+// A normally distributed number (Box-Muller)
+static double gaussian(Rng& rng) {
+    const double u1 = std::max(rng.bounded(1.0), 1e-12);
+    const double u2 = rng.bounded(1.0);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
+
+static void randomize(Genome& genome, Rng& rng) {
+    // Small weights keep every neuron away from tanh's flat ends at the start
+    const double scale = 1.0 / std::sqrt(double(NeuralConfig::Inputs));
+    for (float& w : genome.weights) w = float(gaussian(rng) * scale);
+}
+
+static void mutate(Genome& genome, Rng& rng, const TrainSettings& settings) {
+    for (float& w : genome.weights)
+        if (rng.bounded(1.0) < settings.mutationRate) w += float(gaussian(rng) * settings.mutationSize);
+}
+
+//-----------------------------------------
+// Play one seed and score it. Winning a level is worth 1000, getting close to
+// the current goal up to another 1000, and each death costs 100.
+struct PlayResult {
+    double fitness = 0;
+    int levels = 0;
+    uint64_t ticks = 0;
+};
+
+static PlayResult playSeed(const Genome& genome, uint64_t seed, LevelGenerator generator, int maxTicks) {
+    const Rect bounds = worldBounds();
+    const double diagonal = std::hypot(bounds.w, bounds.h);
+    Simulation sim(seed, bounds, generator);
+    float inputs[NeuralConfig::Inputs];
+
+    PlayResult result;
+    double closest = diagonal;
+    SimState still = sim.state();
+    int stillTicks = 0;
+
+    for (int t = 0; t < maxTicks && !sim.gameOver(); ++t) {
+        senseLevel(sim.level(), sim.state(), inputs);
+        const uint8_t events = sim.step(evaluateNetwork(genome.weights.data(), inputs));
+        result.ticks++;
+        if (events & StepWon) closest = diagonal;
+
+        const SimState& s = sim.state();
+        const Rect& goal = sim.level().goal;
+        const double half = SimConfig::PlayerExtent / 2;
+        closest = std::min(closest, std::hypot(s.x + half - (goal.x + goal.w / 2), s.y + half - (goal.y + goal.h / 2)));
+
+        // A network that stands still will stand still forever; stop early
+        if (s.x == still.x && s.y == still.y && s.verticalVelocity == still.verticalVelocity) {
+            if (++stillTicks > 120) break;
+        } else {
+            still = s;
+            stillTicks = 0;
+        }
+    }
+
+    result.levels = sim.state().level;
+    result.fitness = 1000.0 * sim.state().level + 1000.0 * (1.0 - closest / diagonal) - 100.0 * sim.state().deaths;
+    return result;
+}
+
+//-----------------------------------------
+// Pick the best of a few random genomes
+static int tournament(const std::vector<double>& fitness, Rng& rng) {
+    int best = rng.bounded(0, int(fitness.size()));
+    for (int k = 1; k < 4; ++k) {
+        const int other = rng.bounded(0, int(fitness.size()));
+        if (fitness[size_t(other)] > fitness[size_t(best)]) best = other;
+    }
+    return best;
+}
+
+static std::string elitePath(const std::string& dir, int rank) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "elite_%02d.genome", rank);
+    return (std::filesystem::path(dir) / name).string();
+}
+
+static void saveCheckpoint(const TrainSettings& settings, const std::vector<Genome>& population,
+                           const std::vector<int>& order) {
+    std::filesystem::create_directories(settings.outDir);
+    for (int rank = 0; rank < settings.elite && rank < int(order.size()); ++rank) {
+        if (!saveGenome(elitePath(settings.outDir, rank), population[size_t(order[size_t(rank)])]))
+            std::fprintf(stderr, "Could not write %s\n", elitePath(settings.outDir, rank).c_str());
+    }
+}
+
+//-----------------------------------------
+static void printUsage() {
+    std::printf("usage: neuro_train [--population N] [--generations N] [--seeds N] [--ticks N] [--elite N]\n"
+                "                   [--mutation-rate X] [--mutation-size X] [--checkpoint-every N]\n"
+                "                   [--threads N] [--train-seed N] [--out dir] [--resume dir]\n"
+                "                   [--generator classic|path|chunks|hills]\n");
+}
+
+int main(int argc, char* argv[]) {
+    TrainSettings settings;
+    settings.threads = int(std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                printUsage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (!std::strcmp(arg, "--population")) settings.population = std::max(2, std::atoi(value()));
+        else if (!std::strcmp(arg, "--generations")) settings.generations = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--seeds")) settings.seedsPerGeneration = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--ticks")) settings.ticks = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--elite")) settings.elite = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--mutation-rate")) settings.mutationRate = std::atof(value());
+        else if (!std::strcmp(arg, "--mutation-size")) settings.mutationSize = std::atof(value());
+        else if (!std::strcmp(arg, "--checkpoint-every")) settings.checkpointEvery = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--threads")) settings.threads = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--train-seed")) settings.trainSeed = std::strtoull(value(), nullptr, 10);
+        else if (!std::strcmp(arg, "--out")) settings.outDir = value();
+        else if (!std::strcmp(arg, "--resume")) settings.resumeDir = value();
+        else if (!std::strcmp(arg, "--generator")) {
+            if (!parseGenerator(value(), settings.generator)) {
+                std::fprintf(stderr, "Unknown level generator %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else {
+            printUsage();
+            return !std::strcmp(arg, "--help") || !std::strcmp(arg, "-h") ? 0 : 1;
+        }
+    }
+    settings.elite = std::min(settings.elite, settings.population);
+
+    // The first generation: saved elites (if resuming), then random networks
+    Rng rng(settings.trainSeed * 0x9E3779B97F4A7C15ull + 1);
+    std::vector<Genome> population;
+    if (!settings.resumeDir.empty()) {
+        for (int rank = 0; int(population.size()) < settings.population; ++rank) {
+            Genome genome;
+            if (!loadGenome(elitePath(settings.resumeDir, rank), genome)) break;
+            population.push_back(std::move(genome));
+        }
+        std::printf("resumed %zu genomes from %s\n", population.size(), settings.resumeDir.c_str());
+    }
+    const size_t loaded = population.size();
+    while (int(population.size()) < settings.population) {
+        Genome genome;
+        if (loaded > 0) {
+            genome = population[population.size() % loaded];
+            mutate(genome, rng, settings);
+        } else {
+            randomize(genome, rng);
+        }
+        population.push_back(std::move(genome));
+    }
+
+    std::vector<double> fitness(population.size());
+    std::vector<int> bestLevels(population.size());
+    std::vector<int> order(population.size());
+
+    for (int gen = 0; gen < settings.generations; ++gen) {
+        const auto began = Clock::now();
+        std::vector<uint64_t> seeds;
+        for (int k = 0; k < settings.seedsPerGeneration; ++k)
+            seeds.push_back(settings.trainSeed * 1000003ull + uint64_t(gen) * uint64_t(settings.seedsPerGeneration) + uint64_t(k));
+
+        // Every thread takes the next genome until all of them have played
+        std::atomic<size_t> next{0};
+        std::atomic<uint64_t> ticksPlayed{0};
+        auto worker = [&]() {
+            uint64_t ticks = 0;
+            for (size_t g = next.fetch_add(1); g < population.size(); g = next.fetch_add(1)) {
+                double total = 0;
+                int levels = 0;
+                for (uint64_t seed : seeds) {
+                    const PlayResult result = playSeed(population[g], seed, settings.generator, settings.ticks);
+                    total += result.fitness;
+                    levels += result.levels;
+                    ticks += result.ticks;
+                }
+                fitness[g] = total / double(seeds.size());
+                bestLevels[g] = levels;
+            }
+            ticksPlayed += ticks;
+        };
+        std::vector<std::thread> threads;
+        for (int t = 1; t < settings.threads; ++t) threads.emplace_back(worker);
+        worker();
+        for (std::thread& thread : threads) thread.join();
+
+        // Best first (ties keep the older genome in front, so elites are stable)
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return fitness[size_t(a)] > fitness[size_t(b)]; });
+
+        const double seconds = std::chrono::duration<double>(Clock::now() - began).count();
+        const double mean = std::accumulate(fitness.begin(), fitness.end(), 0.0) / double(fitness.size());
+        std::printf("gen %4d: best %8.1f (%d levels on %d seeds)  mean %8.1f  %.2f s  %.1f M ticks/s\n", gen,
+                    fitness[size_t(order[0])], bestLevels[size_t(order[0])], settings.seedsPerGeneration, mean, seconds,
+                    double(ticksPlayed.load()) / std::max(seconds, 1e-9) / 1e6);
+
+        if ((gen + 1) % settings.checkpointEvery == 0 || gen + 1 == settings.generations)
+            saveCheckpoint(settings, population, order);
+        if (gen + 1 == settings.generations) break;
+
+        // Breed the next generation
+        std::vector<Genome> children;
+        children.reserve(population.size());
+        for (int rank = 0; rank < settings.elite; ++rank) children.push_back(population[size_t(order[size_t(rank)])]);
+        while (children.size() < population.size()) {
+            const Genome& mother = population[size_t(tournament(fitness, rng))];
+            const Genome& father = population[size_t(tournament(fitness, rng))];
+            Genome child = mother;
+            for (size_t w = 0; w < child.weights.size(); ++w)
+                if (rng.next() & 1) child.weights[w] = father.weights[w];
+            mutate(child, rng, settings);
+            children.push_back(std::move(child));
+        }
+        population.swap(children);
+    }
+
+    std::printf("best genomes saved in %s\n", settings.outDir.c_str());
+    return 0;
+}
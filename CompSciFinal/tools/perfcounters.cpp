@@ -0,0 +1,92 @@
+#include "perfcounters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+
+//-----------------------------------------
+// The events we ask for. Each one is opened on its own, so a machine that
+// lacks one of them (common in VMs) still gets the others.
+struct EventSpec {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+static uint64_t cacheEvent(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+static const EventSpec Events[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1d_misses", PERF_TYPE_HW_CACHE,
+     cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"llc_misses", PERF_TYPE_HW_CACHE,
+     cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+PerfCounters::PerfCounters() {
+    for (const EventSpec& event : Events) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;      // Only our own code, and allowed at paranoid level 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // This process, any CPU, no group
+        const int fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd >= 0) counters.push_back(Counter{event.name, fd});
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (const Counter& c : counters) close(c.fd);
+}
+
+void PerfCounters::start() {
+    for (const Counter& c : counters) {
+        ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::stop() {
+    for (const Counter& c : counters) ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+std::vector<PerfCounters::Reading> PerfCounters::read() const {
+    std::vector<Reading> readings;
+    for (const Counter& c : counters) {
+        // value, time enabled, time running
+        uint64_t data[3] = {0, 0, 0};
+        if (::read(c.fd, data, sizeof(data)) != ssize_t(sizeof(data))) continue;
+
+        // When more counters are open than the CPU has, the kernel takes turns;
+        // scale the count up to the whole time it was enabled
+        double value = double(data[0]);
+        if (data[2] > 0 && data[2] < data[1]) value *= double(data[1]) / double(data[2]);
+        readings.push_back(Reading{c.name, value});
+    }
+    return readings;
+}
+
+#else
+
+// No perf_event_open here: benchmarks just run without counters
+PerfCounters::PerfCounters() {}
+PerfCounters::~PerfCounters() {}
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+std::vector<PerfCounters::Reading> PerfCounters::read() const { return {}; }
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+// Hardware performance counters for benchmarks (Linux perf_event_open).
+// They tell us *why* something is fast or slow: cycles, instructions,
+// cache misses and branch misses. On other systems, or when the kernel does
+// not allow it (see /proc/sys/kernel/perf_event_paranoid), nothing is counted.
+#include <cstdint>
+#include <vector>
+
+class PerfCounters {
+public:
+    struct Reading {
+        const char* name;
+        double value;     // Scaled up if the kernel had to share the counter
+    };
+
+    PerfCounters();       // Opens every counter this machine allows
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return !counters.empty(); }
+
+    void start();         // Reset and start counting
+    void stop();          // Stop counting
+    std::vector<Reading> read() const;
+
+private:
+    struct Counter {
+        const char* name;
+        int fd;
+    };
+    std::vector<Counter> counters;
+};
+
+#endif // PERFCOUNTERS_H
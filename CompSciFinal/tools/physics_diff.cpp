@@ -0,0 +1,257 @@
+// physics_diff: plays the same seeds and inputs through the real GameView and
+// the headless Simulation side by side, and reports the first tick where they
+// disagree. Two things are checked every tick:
+//   - the state: GameView::updatePosition() against Simulation::step()
+//   - the contacts: the engine's ContactTracker against Qt itself. The level is
+//     also built as the QGraphicsItems the game used to have (an ellipse for the
+//     goal, polygons for spikes, rects for checkpoints), and collidesWithItem()
+//     decides what the player touches where the game tests it. GameView and the
+//     Simulation share the tracker now, so this is what still catches a bug in it.
+//
+//   physics_diff --runs 500 --ticks 3000
+//   physics_diff --runs 100 --save-failures diffs/
+//
+// Half of the runs use random held keys, the other half let the SearchBot
+// play so later levels (with spikes) get covered too. Any faster engine has
+// to pass this before it replaces the reference code.
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QGraphicsEllipseItem>
+#include <QGraphicsPolygonItem>
+#include <QGraphicsRectItem>
+#include <QGraphicsScene>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include "bot.h"
+#include "contacts.h"
+#include "gameview.h"
+#include "replay.h"
+#include "simulation.h"
+
+//-----------------------------------------
+// The parts of the state both versions keep (GameView also counts game over ticks)
+static bool sameState(const SimState& a, const SimState& b) {
+    return a.x == b.x && a.y == b.y && a.verticalVelocity == b.verticalVelocity &&
+           a.deaths == b.deaths && a.level == b.level && a.checkpoint.index == b.checkpoint.index;
+}
+
+static void printState(const char* name, const SimState& s) {
+    std::printf("    %-10s x=%.2f y=%.2f vv=%d deaths=%d level=%d\n", name, s.x, s.y, s.verticalVelocity, s.deaths, s.level);
+}
+
+static QString inputName(quint8 input) {
+    QString name;
+    if (input & InputLeft) name += 'A';
+    if (input & InputRight) name += 'D';
+    if (input & InputJump) name += 'W';
+    return name.isEmpty() ? QString("-") : name;
+}
+
+static QString eventsText(const std::vector<ContactEvent>& events) {
+    static const char* const kinds[] = {"goal", "spike", "checkpoint"};
+    QString text;
+    for (const ContactEvent& e : events)
+        text += QString("%1%2 %3 ").arg(e.change == ContactEnter ? '+' : '-').arg(kinds[e.kind]).arg(e.index);
+    return text.isEmpty() ? QString("none") : text.trimmed();
+}
+
+static bool sameEvents(const std::vector<ContactEvent>& a, const std::vector<ContactEvent>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].kind != b[i].kind || a[i].change != b[i].change || a[i].index != b[i].index) return false;
+    return true;
+}
+
+//-----------------------------------------
+// The contact reference: the level as Qt items, tested with collidesWithItem()
+// against a player item like the game's (a 20x20 rect with the default pen).
+// It reports enters and exits in the same order as ContactTracker.
+class QtContactOracle {
+public:
+    void build(const LevelData& level) {
+        scene.clear();
+        targets.clear();
+        player = new QGraphicsRectItem(0, 0, LevelConfig::PlayerSize, LevelConfig::PlayerSize);
+        scene.addItem(player);
+
+        add(new QGraphicsEllipseItem(level.goal.x, level.goal.y, level.goal.w, level.goal.h), ContactGoal, 0);
+        for (size_t i = 0; i < level.spikes.size(); ++i) {
+            const Triangle& t = level.spikes[i];
+            QPolygonF triangle;
+            triangle << QPointF(t.apex.x, t.apex.y) << QPointF(t.left.x, t.left.y) << QPointF(t.right.x, t.right.y);
+            add(new QGraphicsPolygonItem(triangle), ContactSpike, uint32_t(i));
+        }
+        for (size_t i = 0; i < level.checkpoints.size(); ++i) {
+            const Rect& c = level.checkpoints[i];
+            add(new QGraphicsRectItem(c.x, c.y, c.w, c.h), ContactCheckpoint, uint32_t(i));
+        }
+        reset();
+    }
+
+    // The player was moved somewhere else: everything it touches next is new
+    void reset() { touching.assign(targets.size(), false); }
+
+    void update(double x, double y, std::vector<ContactEvent>& events) {
+        events.clear();
+        player->setPos(x, y);
+        std::vector<bool> now(targets.size());
+        for (size_t i = 0; i < targets.size(); ++i) now[i] = player->collidesWithItem(targets[i].item);
+        for (size_t i = 0; i < targets.size(); ++i)
+            if (now[i] && !touching[i]) events.push_back(ContactEvent{targets[i].kind, ContactEnter, targets[i].index});
+        for (size_t i = 0; i < targets.size(); ++i)
+            if (!now[i] && touching[i]) events.push_back(ContactEvent{targets[i].kind, ContactExit, targets[i].index});
+        touching.swap(now);
+    }
+
+private:
+    struct Target {
+        QGraphicsItem* item;
+        ContactKind kind;
+        uint32_t index;
+    };
+
+    void add(QGraphicsItem* item, ContactKind kind, uint32_t index) {
+        scene.addItem(item);
+        targets.push_back(Target{item, kind, index});
+    }
+
+    QGraphicsScene scene;
+    QGraphicsRectItem* player = nullptr;
+    std::vector<Target> targets;
+    std::vector<bool> touching;
+};
+
+//-----------------------------------------
+int main(int argc, char* argv[]) {
+    // GameView is a widget, but it never has to be shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compare GameView physics with the headless Simulation tick by tick.");
+    parser.addHelpOption();
+    QCommandLineOption runsOption("runs", "Number of runs (each with its own seed).", "n", "200");
+    QCommandLineOption ticksOption("ticks", "Ticks per run.", "n", "3000");
+    QCommandLineOption firstSeedOption("first-seed", "Seed of the first run.", "seed", "1");
+    QCommandLineOption saveOption("save-failures", "Save each diverging run as a replay in <dir>.", "dir");
+    parser.addOptions({runsOption, ticksOption, firstSeedOption, saveOption});
+    parser.process(app);
+
+    const int runs = std::max(1, parser.value(runsOption).toInt());
+    const int ticks = std::max(1, parser.value(ticksOption).toInt());
+    const quint64 firstSeed = parser.value(firstSeedOption).toULongLong();
+    const QString saveDir = parser.value(saveOption);
+    if (!saveDir.isEmpty()) QDir().mkpath(saveDir);
+
+    int diverged = 0;
+    qint64 ticksCompared = 0;
+    qint64 contactChecks = 0;
+
+    for (int run = 0; run < runs; ++run) {
+        const quint64 seed = firstSeed + quint64(run);
+        const bool useBot = run % 2 == 1;
+
+        // The reference: the real game view on its own scene
+        QGraphicsScene scene;
+        scene.setSceneRect(0, 0, LevelConfig::WorldWidth, LevelConfig::WorldHeight);
+        GameView view(&scene, seed);
+        quint8 input = 0;
+        view.takeControl([&input]() { return input; });
+
+        // The engine under test
+        const Rect bounds = worldBounds();
+        Simulation sim(seed, bounds);
+        SearchBot bot(seed, bounds, seed);
+        Rng random(seed * 0x9E3779B9ull);
+
+        // The tracker under test and its Qt reference, both fed where the game tests contacts
+        ContactTracker tracker;
+        QtContactOracle oracle;
+        std::vector<ContactEvent> trackerEvents, oracleEvents;
+        tracker.build(sim.level());
+        oracle.build(sim.level());
+
+        Replay replay;
+        replay.seed = seed;
+
+        // What went wrong first, or empty
+        QString failure;
+        auto checkContacts = [&](double x, double y) {
+            tracker.update(x, y, trackerEvents);
+            oracle.update(x, y, oracleEvents);
+            contactChecks++;
+            if (failure.isEmpty() && !sameEvents(trackerEvents, oracleEvents))
+                failure = QString("contacts at x=%1 y=%2: tracker %3, Qt items %4")
+                              .arg(x, 0, 'f', 2).arg(y, 0, 'f', 2).arg(eventsText(trackerEvents), eventsText(oracleEvents));
+        };
+
+        int hold = 0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            if (useBot) {
+                input = bot.nextInput(sim.state());
+            } else if (hold-- <= 0) {
+                input = quint8(random.bounded(0, 8));
+                hold = random.bounded(2, 25);
+            }
+            replay.inputs.push_back(input);
+
+            // Where this tick's contacts are tested: after moving, before winning or dying
+            const SimState before = sim.state();
+            SimState moved = before;
+            movePlayer(sim.level(), bounds, moved, input);
+            checkContacts(moved.x, moved.y);
+
+            view.advance();
+            sim.step(input);
+            ticksCompared++;
+
+            // Follow the game: a new level is tested once at its spawn point, a death forgets all contacts
+            if (sim.state().level != before.level) {
+                tracker.build(sim.level());
+                oracle.build(sim.level());
+                checkContacts(sim.level().spawn.x, sim.level().spawn.y);
+            }
+            if (sim.state().deaths != before.deaths) {
+                tracker.reset();
+                oracle.reset();
+            }
+
+            const SimState reference = view.simState();
+            const bool sameRules = sameState(reference, sim.state());
+            if (sameRules && failure.isEmpty()) {
+                if (sim.gameOver()) break;
+                continue;
+            }
+
+            // Report the first tick that differs, with what led up to it
+            diverged++;
+            std::printf("Seed %llu (%s) diverged at tick %d, input %s\n", (unsigned long long)seed,
+                        useBot ? "bot" : "random", tick, qPrintable(inputName(input)));
+            if (!failure.isEmpty()) std::printf("    %s\n", qPrintable(failure));
+            if (!sameRules) {
+                printState("before", before);
+                printState("GameView", reference);
+                printState("Simulation", sim.state());
+            }
+
+            QString recent;
+            for (int i = std::max(0, tick - 15); i <= tick; ++i) recent += inputName(replay.inputs[i]) + ' ';
+            std::printf("    last inputs: %s\n", qPrintable(recent.trimmed()));
+
+            if (!saveDir.isEmpty()) {
+                const QString path = QDir(saveDir).filePath(QString("diverge_%1.replay").arg(seed));
+                saveReplay(path.toStdString(), replay);
+                std::printf("    saved %s\n", qPrintable(path));
+            }
+            break;
+        }
+    }
+
+    std::printf("%d of %d runs diverged (%lld ticks, %lld contact checks compared)\n", diverged, runs,
+                (long long)ticksCompared, (long long)contactChecks);
+    return diverged == 0 ? 0 : 1;
+}
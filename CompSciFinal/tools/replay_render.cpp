@@ -0,0 +1,207 @@
+// replay_render: turns a recorded run into video frames without opening a window.
+//
+//   replay_render run.replay frames/            -> frames/frame_000000.png, ...
+//   replay_render run.replay clip.y4m --format y4m
+//
+// The replay is simulated once to take a snapshot at the start of every segment,
+// then the segments are simulated again and drawn on several threads at once.
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "framepainter.h"
+#include "replay.h"
+#include "simulation.h"
+
+//-----------------------------------------
+// Y4M is a raw video format: a text header, then "FRAME\n" and the Y, U and V
+// planes for every frame. Every frame has the same size, so each thread can
+// write its frames straight to the right place in the file.
+static const QByteArray FrameMarker = "FRAME\n";
+
+static qint64 y4mFrameBytes(int width, int height) {
+    return FrameMarker.size() + qint64(width) * height * 3 / 2;
+}
+
+// Convert one RGB image into YUV 4:2:0 (full range BT.601, what "C420jpeg" means)
+static void toYuv420(const QImage& image, QByteArray& out) {
+    const int w = image.width();
+    const int h = image.height();
+    out.resize(FrameMarker.size() + w * h * 3 / 2);
+    std::copy(FrameMarker.begin(), FrameMarker.end(), out.begin());
+
+    uchar* yPlane = reinterpret_cast<uchar*>(out.data()) + FrameMarker.size();
+    uchar* uPlane = yPlane + w * h;
+    uchar* vPlane = uPlane + (w / 2) * (h / 2);
+
+    for (int y = 0; y < h; ++y) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for (int x = 0; x < w; ++x) {
+            const int r = qRed(line[x]), g = qGreen(line[x]), b = qBlue(line[x]);
+            yPlane[y * w + x] = uchar((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+
+    // Colour is stored once per 2x2 block of pixels, using their average
+    for (int y = 0; y < h; y += 2) {
+        const QRgb* top = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        const QRgb* bottom = reinterpret_cast<const QRgb*>(image.constScanLine(y + 1));
+        for (int x = 0; x < w; x += 2) {
+            const int r = (qRed(top[x]) + qRed(top[x + 1]) + qRed(bottom[x]) + qRed(bottom[x + 1])) / 4;
+            const int g = (qGreen(top[x]) + qGreen(top[x + 1]) + qGreen(bottom[x]) + qGreen(bottom[x + 1])) / 4;
+            const int b = (qBlue(top[x]) + qBlue(top[x + 1]) + qBlue(bottom[x]) + qBlue(bottom[x + 1])) / 4;
+            const int i = (y / 2) * (w / 2) + x / 2;
+            uPlane[i] = uchar(qBound(0, (-43 * r - 85 * g + 128 * b + 128) / 256 + 128, 255));
+            vPlane[i] = uchar(qBound(0, (128 * r - 107 * g - 21 * b + 128) / 256 + 128, 255));
+        }
+    }
+}
+
+//-----------------------------------------
+int main(int argc, char* argv[]) {
+    // Draw without a display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Render a recorded run to a PNG sequence or a Y4M video.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("replay", "Replay file to render.");
+    parser.addPositionalArgument("output", "Output folder (png) or file (y4m).");
+    QCommandLineOption formatOption("format", "Output format: png or y4m.", "format", "png");
+    QCommandLineOption threadsOption("threads", "Number of render threads.", "n",
+                                     QString::number(std::max(1u, std::thread::hardware_concurrency())));
+    QCommandLineOption segmentOption("segment", "Ticks per segment (one snapshot each).", "ticks", "120");
+    QCommandLineOption atlasOption("atlas", "Draw with the sprites in the image <file>.", "file");
+    parser.addOption(formatOption);
+    parser.addOption(threadsOption);
+    parser.addOption(segmentOption);
+    parser.addOption(atlasOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2) parser.showHelp(1);
+
+    const QString format = parser.value(formatOption);
+    const int threadCount = std::max(1, parser.value(threadsOption).toInt());
+    const int segmentTicks = std::max(1, parser.value(segmentOption).toInt());
+    if (format != "png" && format != "y4m") {
+        std::fprintf(stderr, "Unknown format: %s\n", qPrintable(format));
+        return 1;
+    }
+
+    SpriteAtlas sprites;
+    if (parser.isSet(atlasOption) && !sprites.load(parser.value(atlasOption))) {
+        std::fprintf(stderr, "Could not read sprite atlas: %s\n", qPrintable(parser.value(atlasOption)));
+        return 1;
+    }
+
+    Replay replay;
+    if (!loadReplay(args[0].toStdString(), replay)) {
+        std::fprintf(stderr, "Could not read replay: %s\n", qPrintable(args[0]));
+        return 1;
+    }
+
+    const int width = int(replay.width);
+    const int height = int(replay.height);
+    const int frameCount = int(replay.inputs.size());
+    const Rect bounds{0, 0, replay.width, replay.height};
+    if (format == "y4m" && (width % 2 || height % 2)) {
+        std::fprintf(stderr, "Y4M output needs an even frame size\n");
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Pass 1: simulate the whole replay once, keeping a snapshot at the start of each segment
+    std::vector<SimState> segmentStarts;
+    {
+        Simulation sim(replay.seed, bounds, replay.generator);
+        for (int tick = 0; tick < frameCount; ++tick) {
+            if (tick % segmentTicks == 0) segmentStarts.push_back(sim.snapshot());
+            sim.step(replay.inputs[tick]);
+        }
+    }
+
+    // Prepare the output
+    const QString output = args[1];
+    qint64 headerBytes = 0;
+    if (format == "png") {
+        QDir().mkpath(output);
+    } else {
+        QFile file(output);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "Could not write %s\n", qPrintable(output));
+            return 1;
+        }
+        // 16ms per tick is 62.5 frames per second
+        const QByteArray header = QString("YUV4MPEG2 W%1 H%2 F125:2 Ip A1:1 C420jpeg\n").arg(width).arg(height).toLatin1();
+        file.write(header);
+        headerBytes = header.size();
+        file.resize(headerBytes + frameCount * y4mFrameBytes(width, height));
+    }
+
+    // Pass 2: each thread takes the next segment, restores its snapshot and draws its frames
+    std::atomic<int> nextSegment{0};
+    std::atomic<bool> failed{false};
+    auto worker = [&]() {
+        Simulation sim(replay.seed, bounds, replay.generator);
+        QImage image(width, height, QImage::Format_RGB32);
+        TerrainLayer terrain;
+        QByteArray yuv;
+        QFile file(output);
+        if (format == "y4m" && !file.open(QIODevice::ReadWrite)) {
+            failed = true;
+            return;
+        }
+
+        for (int segment = nextSegment++; segment < int(segmentStarts.size()); segment = nextSegment++) {
+            sim.restore(segmentStarts[segment]);
+            const int first = segment * segmentTicks;
+            const int last = std::min(frameCount, first + segmentTicks);
+
+            for (int tick = first; tick < last; ++tick) {
+                sim.step(replay.inputs[tick]);
+
+                QPainter painter(&image);
+                paintFrame(painter, sim.level(), sim.state(), &terrain, sprites);
+                painter.end();
+
+                if (format == "png") {
+                    const QString name = QString("frame_%1.png").arg(tick, 6, 10, QChar('0'));
+                    if (!image.save(QDir(output).filePath(name))) failed = true;
+                } else {
+                    toYuv420(image, yuv);
+                    file.seek(headerBytes + tick * y4mFrameBytes(width, height));
+                    if (file.write(yuv) != yuv.size()) failed = true;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) threads.emplace_back(worker);
+    for (std::thread& t : threads) t.join();
+
+    if (failed) {
+        std::fprintf(stderr, "Writing frames to %s failed\n", qPrintable(output));
+        return 1;
+    }
+
+    const double seconds = timer.elapsed() / 1000.0;
+    const double playedSeconds = frameCount * SimConfig::TickMs / 1000.0;
+    std::printf("Rendered %d frames in %.2fs (%.1fx real time) on %d threads\n",
+                frameCount, seconds, seconds > 0 ? playedSeconds / seconds : 0.0, threadCount);
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "resultsdb.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "binaryio.h"
+
+//-----------------------------------------
+// Block layout (all numbers little-endian):
+//   "CSFB"  magic
+//   u32     version
+//   u32     row count
+//   u64     lowest seed, u64 highest seed
+//   u64     policy mask (bit n set if policy n has a run in this block)
+//   u32     size of the column data that follows, in bytes
+//   then the columns, each one for every row:
+//     u64 seed, u16 policy, u16 generator, u32 ticks, u16 deaths, u16 levels, u8 completed
+static const char BlockMagic[4] = {'C', 'S', 'F', 'B'};
+static const uint32_t BlockVersion = 1;
+static const size_t RowBytes = 8 + 2 + 2 + 4 + 2 + 2 + 1;
+static const size_t HeaderBytes = 4 + 4 + 4 + 8 + 8 + 8 + 4;
+
+// Where each column starts, in bytes per row before it (the column is at rows * offset)
+enum ColumnOffset : size_t {
+    SeedColumn = 0,
+    PolicyColumn = 8,
+    GeneratorColumn = 10,
+    TicksColumn = 12,
+    DeathsColumn = 16,
+    LevelsColumn = 18,
+    CompletedColumn = 20,
+};
+
+static std::string policiesPath(const std::string& path) {
+    return path + ".policies";
+}
+
+std::vector<std::string> loadPolicyNames(const std::string& path) {
+    std::vector<std::string> names;
+    std::ifstream in(policiesPath(path));
+    std::string line;
+    while (std::getline(in, line)) names.push_back(line);
+    return names;
+}
+
+int policyId(const std::string& path, const std::string& name) {
+    const std::vector<std::string> names = loadPolicyNames(path);
+    for (size_t i = 0; i < names.size(); ++i)
+        if (names[i] == name) return int(i);
+    if (names.size() >= 64) return -1;   // The block index has room for 64
+
+    std::ofstream out(policiesPath(path), std::ios::app);
+    out << name << '\n';
+    return out ? int(names.size()) : -1;
+}
+
+//-----------------------------------------
+// Columns are packed into one buffer and written in a single call
+template <typename T>
+static void putColumn(std::vector<char>& buffer, const std::vector<RunResult>& runs, T RunResult::*field) {
+    for (const RunResult& run : runs) {
+        const uint64_t bits = uint64_t(run.*field);
+        for (size_t i = 0; i < sizeof(T); ++i) buffer.push_back(char((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+// Read just one column of the block whose columns start at "columns"
+template <typename T>
+static bool getColumn(std::istream& in, std::streampos columns, size_t offset, uint32_t rows,
+                      std::vector<uint8_t>& data, std::vector<T>& column) {
+    data.resize(size_t(rows) * sizeof(T));
+    in.seekg(columns + std::streamoff(offset * rows));
+    if (!in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()))) return false;
+
+    column.resize(rows);
+    const uint8_t* p = data.data();
+    for (uint32_t r = 0; r < rows; ++r) {
+        uint64_t bits = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) bits |= uint64_t(p[i]) << (8 * i);
+        column[r] = T(bits);
+        p += sizeof(T);
+    }
+    return true;
+}
+
+//-----------------------------------------
+// The length of the whole blocks at the start of the file. Anything after them
+// is a block a crash cut short.
+static uint64_t wholeBlocksLength(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(path, error);
+    if (!in || error) return 0;
+
+    uint64_t length = 0;
+    for (;;) {
+        char magic[4];
+        uint32_t version = 0, rows = 0, bytes = 0;
+        uint64_t seedMin = 0, seedMax = 0, policies = 0;
+        if (!in.read(magic, 4) || std::memcmp(magic, BlockMagic, 4) != 0) break;
+        if (!readLE(in, version) || !readLE(in, rows) || !readLE(in, seedMin) || !readLE(in, seedMax) ||
+            !readLE(in, policies) || !readLE(in, bytes))
+            break;
+        if (version != BlockVersion || bytes != rows * RowBytes || length + HeaderBytes + bytes > size) break;
+        length += HeaderBytes + bytes;
+        in.seekg(std::streamoff(length));
+    }
+    return length;
+}
+
+bool appendResults(const std::string& path, const std::vector<RunResult>& runs) {
+    if (runs.empty()) return true;
+
+    // Cut off a torn last block, or every block after it could never be read
+    std::error_code error;
+    if (std::filesystem::exists(path, error)) {
+        const uint64_t length = wholeBlocksLength(path);
+        if (length != std::filesystem::file_size(path, error)) {
+            std::filesystem::resize_file(path, length, error);
+            if (error) return false;
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    if (!out) return false;
+
+    uint64_t seedMin = UINT64_MAX, seedMax = 0, policies = 0;
+    for (const RunResult& run : runs) {
+        seedMin = std::min(seedMin, run.seed);
+        seedMax = std::max(seedMax, run.seed);
+        policies |= uint64_t(1) << (run.policy & 63);
+    }
+
+    std::vector<char> columns;
+    columns.reserve(runs.size() * RowBytes);
+    putColumn(columns, runs, &RunResult::seed);
+    putColumn(columns, runs, &RunResult::policy);
+    putColumn(columns, runs, &RunResult::generator);
+    putColumn(columns, runs, &RunResult::ticks);
+    putColumn(columns, runs, &RunResult::deaths);
+    putColumn(columns, runs, &RunResult::levels);
+    putColumn(columns, runs, &RunResult::completed);
+
+    out.write(BlockMagic, 4);
+    writeLE(out, BlockVersion);
+    writeLE(out, uint32_t(runs.size()));
+    writeLE(out, seedMin);
+    writeLE(out, seedMax);
+    writeLE(out, policies);
+    writeLE(out, uint32_t(columns.size()));
+    out.write(columns.data(), std::streamsize(columns.size()));
+    return bool(out.flush());
+}
+
+//-----------------------------------------
+bool scanResults(const std::string& path, const ResultsFilter& filter, ResultsScan& scan, uint32_t fields) {
+    std::ifstream in(path, std::ios::binary);
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(path, error);
+    if (!in || error) return false;
+
+    std::vector<uint8_t> data;
+    std::vector<uint64_t> seeds;
+    std::vector<uint16_t> policy, generator, deaths, levels;
+    std::vector<uint32_t> ticks;
+    std::vector<uint8_t> completed;
+
+    for (;;) {
+        char magic[4];
+        uint32_t version = 0, rows = 0, bytes = 0;
+        uint64_t seedMin = 0, seedMax = 0, policies = 0;
+        if (!in.read(magic, 4)) break;   // End of file
+        if (std::memcmp(magic, BlockMagic, 4) != 0) return false;
+        if (!readLE(in, version) || !readLE(in, rows) || !readLE(in, seedMin) || !readLE(in, seedMax) ||
+            !readLE(in, policies) || !readLE(in, bytes))
+            break;
+        if (version != BlockVersion || bytes != rows * RowBytes) return false;
+        const std::streampos columns = in.tellg();
+        if (uint64_t(columns) + bytes > size) break;   // Cut short
+
+        // The index says nothing in here can match: jump over the columns
+        if (seedMax < filter.seedMin || seedMin > filter.seedMax || !(policies & filter.policies)) {
+            in.seekg(columns + std::streamoff(bytes));
+            scan.blocksSkipped++;
+            continue;
+        }
+
+        // Only the columns this query needs. The seeds are only needed if the
+        // block is partly outside the seed range.
+        const bool checkSeeds = seedMin < filter.seedMin || seedMax > filter.seedMax;
+        if ((checkSeeds && !getColumn(in, columns, SeedColumn, rows, data, seeds)) ||
+            !getColumn(in, columns, PolicyColumn, rows, data, policy) ||
+            !getColumn(in, columns, GeneratorColumn, rows, data, generator) ||
+            ((fields & FieldTicks) && !getColumn(in, columns, TicksColumn, rows, data, ticks)) ||
+            ((fields & FieldDeaths) && !getColumn(in, columns, DeathsColumn, rows, data, deaths)) ||
+            ((fields & FieldLevels) && !getColumn(in, columns, LevelsColumn, rows, data, levels)) ||
+            ((fields & FieldCompleted) && !getColumn(in, columns, CompletedColumn, rows, data, completed)))
+            break;
+        in.seekg(columns + std::streamoff(bytes));
+        scan.blocksRead++;
+
+        // Runs are written in long stretches of the same policy, so the map is
+        // only searched when the group changes
+        ResultsSummary* sum = nullptr;
+        std::pair<uint16_t, uint16_t> group;
+        for (uint32_t r = 0; r < rows; ++r) {
+            if (checkSeeds && (seeds[r] < filter.seedMin || seeds[r] > filter.seedMax)) continue;
+            if (!(filter.policies >> (policy[r] & 63) & 1)) continue;
+            if (!sum || group.first != policy[r] || group.second != generator[r]) {
+                group = {policy[r], generator[r]};
+                sum = &scan.groups[group];
+            }
+            sum->runs++;
+            if (fields & FieldCompleted) sum->completed += completed[r];
+            if (fields & FieldTicks) sum->ticks += ticks[r];
+            if (fields & FieldDeaths) sum->deaths += deaths[r];
+            if (fields & FieldLevels) sum->levels += levels[r];
+        }
+    }
+    return true;
+}
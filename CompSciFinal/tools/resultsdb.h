@@ -0,0 +1,82 @@
+#ifndef RESULTSDB_H
+#define RESULTSDB_H
+
+// An append-only file of bot runs, stored by column so that summing one field
+// over millions of runs only reads that field (plus the policy and generator
+// columns the results are grouped by, and the seeds when a block is only partly
+// inside the seed range).
+//
+// The file is a list of blocks. Each block holds up to a few thousand runs with
+// every column stored one after the other, and starts with a small index: the
+// lowest and highest seed in it and which policies appear in it. Queries skip
+// whole blocks using that index without reading their columns.
+//
+// Policy names are kept next to it in "<file>.policies", one per line (the
+// line number is the policy id stored in the runs).
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+//-----------------------------------------
+// One run of one policy on one seed
+struct RunResult {
+    uint64_t seed = 0;
+    uint16_t policy = 0;       // Id from the .policies file
+    uint16_t generator = 0;    // Which level generator made the levels (0 = the original)
+    uint32_t ticks = 0;        // Ticks played
+    uint16_t deaths = 0;
+    uint16_t levels = 0;       // Levels won
+    uint8_t completed = 0;     // 1 if it won every level it was asked to
+};
+
+//-----------------------------------------
+// Which runs a query looks at. Policies are a bit mask of ids (up to 64 policies).
+struct ResultsFilter {
+    uint64_t seedMin = 0;
+    uint64_t seedMax = UINT64_MAX;
+    uint64_t policies = UINT64_MAX;
+};
+
+// The fields a scan adds up. The others are left at 0 and their columns are never read.
+enum ResultsField : uint32_t {
+    FieldTicks = 1 << 0,
+    FieldDeaths = 1 << 1,
+    FieldLevels = 1 << 2,
+    FieldCompleted = 1 << 3,
+    AllFields = FieldTicks | FieldDeaths | FieldLevels | FieldCompleted,
+};
+
+// Totals for one (policy, generator) pair
+struct ResultsSummary {
+    uint64_t runs = 0;
+    uint64_t completed = 0;
+    uint64_t ticks = 0;
+    uint64_t deaths = 0;
+    uint64_t levels = 0;
+};
+
+struct ResultsScan {
+    std::map<std::pair<uint16_t, uint16_t>, ResultsSummary> groups;   // By (policy, generator)
+    uint64_t blocksRead = 0;
+    uint64_t blocksSkipped = 0;
+};
+
+//-----------------------------------------
+// Policy names <-> ids for a results file
+std::vector<std::string> loadPolicyNames(const std::string& path);
+// The id of "name", adding it to the .policies file if it is new (-1 on error)
+int policyId(const std::string& path, const std::string& name);
+
+// Add one block of runs to the end of the file. A block cut short by a crash
+// while writing is cut off first, so the new block can be read after it.
+// Returns false on a write error.
+bool appendResults(const std::string& path, const std::vector<RunResult>& runs);
+
+// Sum up "fields" (ResultsField bits) of every run that matches the filter.
+// Returns false if the file could not be read; a block cut short ends the scan.
+bool scanResults(const std::string& path, const ResultsFilter& filter, ResultsScan& scan,
+                 uint32_t fields = AllFields);
+
+#endif // RESULTSDB_H
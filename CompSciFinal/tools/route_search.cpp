@@ -0,0 +1,324 @@
+// route_search: finds a fast input sequence for a seed with beam search and
+// saves it as a replay (play it with CompSciFinal --play route.replay).
+//
+//   route_search --seed 42 --levels 5 -o route.replay
+//   route_search --seed 42 --levels 5 --beam 50000 --threads 8
+//
+// Every tick, each state in the beam is copied into a Simulation with restore()
+// and stepped once per useful input. The children are de-duplicated, and the
+// ones closest to the goal are kept for the next tick, spread out over the level
+// so the beam does not all pile up under the goal. The first child that reaches
+// the goal ends the level, so the route found is the shortest one the beam saw.
+// Levels are searched one after another, each starting where the last one won.
+//
+// Only the current beam keeps whole states. Earlier ticks keep just a parent
+// index and an input per state (5 bytes), which is enough to rebuild the route,
+// and a level is given up on once those links pass --max-memory.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "level.h"
+#include "replay.h"
+#include "simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+//-----------------------------------------
+// Left+Right cancel out, so only these six inputs lead to different states
+static const uint8_t Moves[] = {
+    0, InputLeft, InputRight, InputJump, InputLeft | InputJump, InputRight | InputJump,
+};
+static constexpr int MoveCount = int(sizeof(Moves) / sizeof(Moves[0]));
+
+// One state in the beam. "parent" is its index in the previous tick's beam,
+// which is all we need to walk back and rebuild the inputs at the end.
+struct Node {
+    SimState state;
+    uint32_t parent;
+    uint8_t input;
+    double score;     // Distance to the goal; smaller is better
+    uint64_t key;     // Quantised position and velocity packed together, to find duplicates
+    int cell;         // Coarse grid cell, to keep the beam spread out
+};
+
+struct SearchSettings {
+    int beamWidth = 20000;   // States kept every tick
+    int perCell = 64;        // At most this many of them in one grid cell
+    int maxTicks = 3000;     // Give up on a level after this many ticks
+    int maxMemoryMB = 256;   // ...or once the links back to the start take this much
+    int threads = 1;
+    LevelGenerator generator = LevelGenerator::Classic;
+};
+
+static constexpr double CellSize = 25;   // Grid cell size in pixels
+
+//-----------------------------------------
+// Distance from the middle of the player to the middle of the goal
+static double goalDistance(const SimState& s, const Rect& goal) {
+    const double half = SimConfig::PlayerExtent / 2;
+    return std::hypot(s.x + half - (goal.x + goal.w / 2), s.y + half - (goal.y + goal.h / 2));
+}
+
+// The state rounded to half pixels. On flat levels positions only move in whole
+// or half pixels, so this is exact there. On hills y follows the terrain's
+// heights and can fall between half pixels, so two states less than a quarter
+// pixel apart count as the same one: the dedupe is approximate, but the state
+// that is kept is always a real one, so the route still replays exactly.
+static uint64_t stateKey(const SimState& s) {
+    const uint64_t x = uint64_t(int64_t(std::lround(s.x * 2)) & 0xFFFFF);
+    const uint64_t y = uint64_t(int64_t(std::lround(s.y * 2)) & 0xFFFFF);
+    const uint64_t v = uint64_t(int64_t(s.verticalVelocity) & 0xFFFFF);
+    return x << 40 | y << 20 | v;
+}
+
+//-----------------------------------------
+// How every state in one tick's beam was reached from the tick before
+struct BeamLinks {
+    std::vector<uint32_t> parents;
+    std::vector<uint8_t> inputs;
+};
+
+// What one level's search found
+struct LevelRoute {
+    bool found = false;
+    bool outOfMemory = false;     // Gave up because of --max-memory, not --max-ticks
+    std::vector<uint8_t> inputs;
+    SimState end;                 // State right after winning
+    uint64_t statesExpanded = 0;
+};
+
+static LevelRoute searchLevel(uint64_t seed, const Rect& bounds, const SimState& start,
+                              const SearchSettings& settings) {
+    LevelRoute route;
+    const LevelData level = generateLevelData(seed, start.level, bounds, settings.generator);
+    const int gridW = int(bounds.w / CellSize) + 1;
+    const int gridH = int(bounds.h / CellSize) + 1;
+
+    // The current beam, and the links from every earlier beam so the winning route can be read back
+    std::vector<Node> beam{Node{start, 0, 0, goalDistance(start, level.goal), stateKey(start), 0}};
+    std::vector<BeamLinks> links;
+    size_t linkBytes = 0;
+    const size_t maxLinkBytes = size_t(settings.maxMemoryMB) << 20;
+
+    // Each thread has its own Simulation, already on this level
+    const int threadCount = std::max(1, settings.threads);
+    std::vector<Simulation> sims;
+    std::vector<std::vector<Node>> children(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        sims.emplace_back(seed, bounds, settings.generator);
+        sims.back().restore(start);
+    }
+
+    for (int tick = 0; tick < settings.maxTicks; ++tick) {
+        // Expand the beam in chunks handed out to the threads. The winner with the
+        // lowest index wins, so the result does not depend on thread timing.
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<uint64_t> winner{UINT64_MAX};
+        const size_t chunk = 256;
+
+        auto expand = [&](int t) {
+            Simulation& sim = sims[t];
+            std::vector<Node>& out = children[t];
+            out.clear();
+            for (;;) {
+                const size_t begin = nextChunk.fetch_add(chunk);
+                if (begin >= beam.size()) break;
+                const size_t end = std::min(beam.size(), begin + chunk);
+                for (size_t i = begin; i < end; ++i) {
+                    const SimState& parent = beam[i].state;
+                    for (int m = 0; m < MoveCount; ++m) {
+                        sim.restore(parent);
+                        const uint8_t events = sim.step(Moves[m]);
+                        if (events & StepWon) {
+                            // Keep the smallest (parent, move) so every run picks the same one
+                            const uint64_t id = uint64_t(i) * MoveCount + uint64_t(m);
+                            uint64_t best = winner.load();
+                            while (id < best && !winner.compare_exchange_weak(best, id)) {}
+                            sim.restore(parent);   // Back to this level for the next child
+                            continue;
+                        }
+                        // Dying only costs time and lives, never worth keeping
+                        if (events & (StepDied | StepGameOver)) continue;
+
+                        const SimState& s = sim.state();
+                        const int cx = std::clamp(int((s.x - bounds.x) / CellSize), 0, gridW - 1);
+                        const int cy = std::clamp(int((s.y - bounds.y) / CellSize), 0, gridH - 1);
+                        out.push_back(Node{s, uint32_t(i), Moves[m], goalDistance(s, level.goal), stateKey(s),
+                                           cy * gridW + cx});
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threadCount; ++t) workers.emplace_back(expand, t);
+        expand(0);
+        for (std::thread& worker : workers) worker.join();
+        route.statesExpanded += beam.size() * MoveCount;
+
+        // Found the goal: walk back through the links to get the inputs
+        if (winner.load() != UINT64_MAX) {
+            const uint64_t id = winner.load();
+            uint32_t index = uint32_t(id / MoveCount);
+            route.inputs.push_back(Moves[id % MoveCount]);
+            for (size_t t = links.size(); t-- > 0;) {
+                route.inputs.push_back(links[t].inputs[index]);
+                index = links[t].parents[index];
+            }
+            std::reverse(route.inputs.begin(), route.inputs.end());
+
+            Simulation& sim = sims[0];
+            sim.restore(beam[uint32_t(id / MoveCount)].state);
+            sim.step(Moves[id % MoveCount]);
+            route.end = sim.state();
+            route.found = true;
+            return route;
+        }
+
+        // Gather the children, drop duplicates (same stateKey())
+        std::vector<Node> next;
+        for (std::vector<Node>& part : children) next.insert(next.end(), part.begin(), part.end());
+        if (next.empty()) return route;
+        std::sort(next.begin(), next.end(), [](const Node& a, const Node& b) {
+            return a.key != b.key ? a.key < b.key : a.parent < b.parent;
+        });
+        next.erase(std::unique(next.begin(), next.end(), [](const Node& a, const Node& b) { return a.key == b.key; }),
+                   next.end());
+
+        // Best first, but only a few per grid cell
+        std::sort(next.begin(), next.end(), [](const Node& a, const Node& b) {
+            return a.score != b.score ? a.score < b.score : a.key < b.key;
+        });
+        std::vector<int> cellCount(size_t(gridW * gridH), 0);
+        std::vector<Node> kept;
+        kept.reserve(std::min(next.size(), size_t(settings.beamWidth)));
+        for (const Node& node : next) {
+            if (int(kept.size()) >= settings.beamWidth) break;
+            if (cellCount[size_t(node.cell)]++ >= settings.perCell) continue;
+            kept.push_back(node);
+        }
+
+        BeamLinks step;
+        step.parents.reserve(kept.size());
+        step.inputs.reserve(kept.size());
+        for (const Node& node : kept) {
+            step.parents.push_back(node.parent);
+            step.inputs.push_back(node.input);
+        }
+        linkBytes += kept.size() * (sizeof(uint32_t) + sizeof(uint8_t));
+        links.push_back(std::move(step));
+        beam.swap(kept);
+
+        if (linkBytes > maxLinkBytes) {
+            route.outOfMemory = true;
+            return route;
+        }
+    }
+    return route;
+}
+
+//-----------------------------------------
+static void printUsage() {
+    std::printf("usage: route_search --seed N [--levels N] [--beam N] [--per-cell N] [--max-ticks N] "
+                "[--max-memory MB] [--threads N] [--generator classic|path|chunks|hills] [-o file]\n");
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = 1;
+    int levels = 3;
+    SearchSettings settings;
+    settings.threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    std::string outPath = "route.replay";
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                printUsage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (!std::strcmp(arg, "--seed")) seed = std::strtoull(value(), nullptr, 10);
+        else if (!std::strcmp(arg, "--levels")) levels = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--beam")) settings.beamWidth = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--per-cell")) settings.perCell = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--max-ticks")) settings.maxTicks = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--max-memory")) settings.maxMemoryMB = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "--threads")) settings.threads = std::max(1, std::atoi(value()));
+        else if (!std::strcmp(arg, "-o") || !std::strcmp(arg, "--output")) outPath = value();
+        else if (!std::strcmp(arg, "--generator")) {
+            if (!parseGenerator(value(), settings.generator)) {
+                std::fprintf(stderr, "Unknown level generator %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else {
+            printUsage();
+            return !std::strcmp(arg, "--help") || !std::strcmp(arg, "-h") ? 0 : 1;
+        }
+    }
+
+    const Rect bounds = worldBounds();
+    Replay replay;
+    replay.seed = seed;
+    replay.width = bounds.w;
+    replay.height = bounds.h;
+    replay.generator = settings.generator;
+
+    Simulation start(seed, bounds, settings.generator);
+    SimState state = start.state();
+    uint64_t totalStates = 0;
+    const auto began = Clock::now();
+    bool complete = true;
+
+    for (int l = 0; l < levels; ++l) {
+        const auto levelBegan = Clock::now();
+        const LevelRoute route = searchLevel(seed, bounds, state, settings);
+        const double seconds = std::chrono::duration<double>(Clock::now() - levelBegan).count();
+        totalStates += route.statesExpanded;
+
+        if (!route.found) {
+            if (route.outOfMemory)
+                std::printf("level %d: no route within %d MB of route links (%llu states)\n", state.level,
+                            settings.maxMemoryMB, (unsigned long long)route.statesExpanded);
+            else
+                std::printf("level %d: no route within %d ticks (%llu states)\n", state.level, settings.maxTicks,
+                            (unsigned long long)route.statesExpanded);
+            complete = false;
+            break;
+        }
+        std::printf("level %d: %zu ticks, %llu states in %.2f s (%.1f M states/s)\n", state.level,
+                    route.inputs.size(), (unsigned long long)route.statesExpanded, seconds,
+                    route.statesExpanded / std::max(seconds, 1e-9) / 1e6);
+        replay.inputs.insert(replay.inputs.end(), route.inputs.begin(), route.inputs.end());
+        state = route.end;
+    }
+
+    // Check the route by playing it from the start, like GameView will
+    Simulation check(seed, bounds, settings.generator);
+    for (uint8_t input : replay.inputs) check.step(input);
+    const double seconds = std::chrono::duration<double>(Clock::now() - began).count();
+    std::printf("total: %zu ticks for %d levels, %llu states in %.2f s (%.1f M states/s)\n", replay.inputs.size(),
+                check.state().level, (unsigned long long)totalStates, seconds, totalStates / std::max(seconds, 1e-9) / 1e6);
+    if (check.state().level != state.level || check.state().deaths != 0) {
+        std::fprintf(stderr, "Replaying the route did not give the same result\n");
+        return 1;
+    }
+
+    if (replay.inputs.empty()) return 1;
+    if (!saveReplay(outPath, replay)) {
+        std::fprintf(stderr, "Could not write %s\n", outPath.c_str());
+        return 1;
+    }
+    std::printf("saved %s\n", outPath.c_str());
+    return complete ? 0 : 2;
+}
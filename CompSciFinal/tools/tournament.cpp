@@ -0,0 +1,350 @@
+// tournament: plays several bot policies on the same seeds and keeps every
+// outcome in a results file (see resultsdb.h), then sums them up.
+//
+//   tournament run results.db --policies search,random,neural:brains/elite_00.genome --seeds 1-1000
+//   tournament query results.db
+//   tournament query results.db --policy search --seeds 1-500
+//   tournament query results.db --policy neural:brains/elite_00.genome
+//
+// A run plays one seed until the policy has won --levels levels, runs out of
+// lives or reaches --ticks. Runs are spread over every core and written one
+// block at a time, so a long tournament can be stopped and queried midway.
+//
+// A neural policy is stored under a hash of its weights ("neural@<hash>"), not
+// its file name, so a genome retrained into the same file counts as a new policy.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bot.h"
+#include "neuralbot.h"
+#include "resultsdb.h"
+#include "simulation.h"
+
+using Clock = std::chrono::steady_clock;
+
+//-----------------------------------------
+// A policy picks the input for each tick. One is made for every run.
+class Policy {
+public:
+    virtual ~Policy() = default;
+    virtual uint8_t nextInput(const Simulation& sim) = 0;
+};
+
+// SearchBot: plans ahead with its own copy of the simulation
+class SearchPolicy : public Policy {
+public:
+    SearchPolicy(uint64_t seed, const Rect& bounds, LevelGenerator generator) : bot(seed, bounds, seed, generator) {}
+    uint8_t nextInput(const Simulation& sim) override { return bot.nextInput(sim.state()); }
+
+private:
+    SearchBot bot;
+};
+
+// Random keys held for a while, the baseline every bot should beat
+class RandomPolicy : public Policy {
+public:
+    explicit RandomPolicy(uint64_t seed) : rng(seed * 0x9E3779B9ull) {}
+    uint8_t nextInput(const Simulation&) override {
+        if (hold-- <= 0) {
+            input = uint8_t(rng.bounded(0, 8));
+            hold = rng.bounded(2, 25);
+        }
+        return input;
+    }
+
+private:
+    Rng rng;
+    uint8_t input = 0;
+    int hold = 0;
+};
+
+// NeuralBot with a trained genome
+class NeuralPolicy : public Policy {
+public:
+    explicit NeuralPolicy(const Genome& genome) : bot(genome) {}
+    uint8_t nextInput(const Simulation& sim) override { return bot.nextInput(sim.level(), sim.state()); }
+
+private:
+    NeuralBot bot;
+};
+
+//-----------------------------------------
+// The name a genome's results are stored under: FNV-1a of its weights
+static std::string genomeKey(const Genome& genome) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (float weight : genome.weights) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &weight, sizeof(bits));
+        for (int i = 0; i < 4; ++i) {
+            hash ^= (bits >> (8 * i)) & 0xFF;
+            hash *= 0x100000001B3ull;
+        }
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), "neural@%016llx", (unsigned long long)hash);
+    return text;
+}
+
+// The stored name of a policy given on the command line (reads the genome of a
+// neural one). Returns false if the genome could not be read.
+static bool policyKey(const std::string& name, std::string& key, Genome* genome = nullptr) {
+    if (name.compare(0, 7, "neural:") != 0) {
+        key = name;
+        return true;
+    }
+    Genome loaded;
+    if (!loadGenome(name.substr(7), loaded)) return false;
+    key = genomeKey(loaded);
+    if (genome) *genome = std::move(loaded);
+    return true;
+}
+
+//-----------------------------------------
+// A policy as named on the command line ("search", "random" or "neural:<file>")
+struct PolicySpec {
+    std::string name;
+    std::string key;   // What it is stored as in the .policies file
+    int id = 0;
+    Genome genome;   // Only for neural policies
+
+    std::unique_ptr<Policy> make(uint64_t seed, const Rect& bounds, LevelGenerator generator) const {
+        if (name == "search") return std::unique_ptr<Policy>(new SearchPolicy(seed, bounds, generator));
+        if (name == "random") return std::unique_ptr<Policy>(new RandomPolicy(seed));
+        return std::unique_ptr<Policy>(new NeuralPolicy(genome));
+    }
+};
+
+static RunResult playRun(const PolicySpec& spec, uint64_t seed, LevelGenerator generator, int levels, int maxTicks) {
+    const Rect bounds = worldBounds();
+    Simulation sim(seed, bounds, generator);
+    std::unique_ptr<Policy> policy = spec.make(seed, bounds, generator);
+
+    RunResult result;
+    result.seed = seed;
+    result.policy = uint16_t(spec.id);
+    result.generator = uint16_t(generator);
+    for (int t = 0; t < maxTicks && !sim.gameOver() && sim.state().level < levels; ++t)
+        sim.step(policy->nextInput(sim));
+
+    result.ticks = sim.state().tick;
+    result.deaths = uint16_t(sim.state().deaths);
+    result.levels = uint16_t(sim.state().level);
+    result.completed = sim.state().level >= levels ? 1 : 0;
+    return result;
+}
+
+//-----------------------------------------
+// "5" or "1-1000"
+static bool parseSeedRange(const char* text, uint64_t& first, uint64_t& last) {
+    char* end = nullptr;
+    first = std::strtoull(text, &end, 10);
+    last = first;
+    if (end == text) return false;
+    if (*end == '-') last = std::strtoull(end + 1, &end, 10);
+    return *end == '\0' && last >= first;
+}
+
+static std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator))
+        if (!part.empty()) parts.push_back(part);
+    return parts;
+}
+
+static void printUsage() {
+    std::printf("usage: tournament run <results> --policies a,b,... [--seeds A-B] [--levels N] [--ticks N] [--threads N]\n"
+                "                                  [--generator classic|path|chunks|hills]\n"
+                "       tournament query <results> [--policy name]... [--seeds A-B]\n"
+                "policies: search, random, neural:<genome file> (stored as neural@<hash of the weights>)\n");
+}
+
+//-----------------------------------------
+static int runTournament(const std::string& path, int argc, char* argv[]) {
+    std::string policyList = "search,random";
+    uint64_t firstSeed = 1, lastSeed = 100;
+    int levels = 5;
+    int maxTicks = 6000;
+    int threadCount = int(std::max(1u, std::thread::hardware_concurrency()));
+    LevelGenerator generator = LevelGenerator::Classic;
+
+    for (int i = 0; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (!std::strcmp(arg, "--policies")) policyList = value;
+        else if (!std::strcmp(arg, "--seeds")) {
+            if (!parseSeedRange(value, firstSeed, lastSeed)) {
+                std::fprintf(stderr, "Bad seed range %s\n", value);
+                return 1;
+            }
+        } else if (!std::strcmp(arg, "--levels")) levels = std::max(1, std::atoi(value));
+        else if (!std::strcmp(arg, "--ticks")) maxTicks = std::max(1, std::atoi(value));
+        else if (!std::strcmp(arg, "--threads")) threadCount = std::max(1, std::atoi(value));
+        else if (!std::strcmp(arg, "--generator")) {
+            if (!parseGenerator(value, generator)) {
+                std::fprintf(stderr, "Unknown level generator %s\n", value);
+                return 1;
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<PolicySpec> specs;
+    for (const std::string& name : split(policyList, ',')) {
+        PolicySpec spec;
+        spec.name = name;
+        if (name.compare(0, 7, "neural:") == 0) {
+            if (!policyKey(name, spec.key, &spec.genome)) {
+                std::fprintf(stderr, "Could not load genome %s\n", name.substr(7).c_str());
+                return 1;
+            }
+            std::printf("%s is stored as %s\n", name.c_str(), spec.key.c_str());
+        } else if (name != "search" && name != "random") {
+            std::fprintf(stderr, "Unknown policy %s\n", name.c_str());
+            return 1;
+        } else {
+            spec.key = name;
+        }
+        spec.id = policyId(path, spec.key);
+        if (spec.id < 0) {
+            std::fprintf(stderr, "Could not register policy %s in %s.policies\n", spec.key.c_str(), path.c_str());
+            return 1;
+        }
+        specs.push_back(std::move(spec));
+    }
+    if (specs.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    // Seeds are played in chunks; every chunk becomes one block of the file.
+    // Inside a block the runs are grouped by policy, which queries like.
+    const uint64_t seedsPerChunk = 1024;
+    const uint64_t totalRuns = (lastSeed - firstSeed + 1) * specs.size();
+    uint64_t runsDone = 0;
+    const auto began = Clock::now();
+
+    for (uint64_t chunkFirst = firstSeed; chunkFirst <= lastSeed; chunkFirst += seedsPerChunk) {
+        const uint64_t chunkSeeds = std::min(seedsPerChunk, lastSeed - chunkFirst + 1);
+        std::vector<RunResult> results(size_t(chunkSeeds * specs.size()));
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < results.size(); i = next.fetch_add(1)) {
+                const PolicySpec& spec = specs[i / chunkSeeds];
+                results[i] = playRun(spec, chunkFirst + i % chunkSeeds, generator, levels, maxTicks);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+        worker();
+        for (std::thread& thread : threads) thread.join();
+
+        if (!appendResults(path, results)) {
+            std::fprintf(stderr, "Could not write %s\n", path.c_str());
+            return 1;
+        }
+        runsDone += results.size();
+        const double seconds = std::chrono::duration<double>(Clock::now() - began).count();
+        std::printf("%llu / %llu runs (%.0f runs/s)\n", (unsigned long long)runsDone, (unsigned long long)totalRuns,
+                    double(runsDone) / std::max(seconds, 1e-9));
+        if (chunkFirst + seedsPerChunk < chunkFirst) break;   // Seed range ends at the top of u64
+    }
+    return 0;
+}
+
+//-----------------------------------------
+static int queryTournament(const std::string& path, int argc, char* argv[]) {
+    const std::vector<std::string> names = loadPolicyNames(path);
+    ResultsFilter filter;
+    bool policyChosen = false;
+
+    for (int i = 0; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (!std::strcmp(arg, "--policy")) {
+            // A genome file is looked up by what it holds now
+            std::string key;
+            if (!policyKey(value, key)) {
+                std::fprintf(stderr, "Could not load genome %s\n", value + 7);
+                return 1;
+            }
+            const auto found = std::find(names.begin(), names.end(), key);
+            if (found == names.end()) {
+                std::fprintf(stderr, "No policy called %s in %s\n", value, path.c_str());
+                return 1;
+            }
+            if (!policyChosen) filter.policies = 0;
+            policyChosen = true;
+            filter.policies |= uint64_t(1) << (found - names.begin());
+        } else if (!std::strcmp(arg, "--seeds")) {
+            if (!parseSeedRange(value, filter.seedMin, filter.seedMax)) {
+                std::fprintf(stderr, "Bad seed range %s\n", value);
+                return 1;
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    const auto began = Clock::now();
+    ResultsScan scan;
+    if (!scanResults(path, filter, scan)) {
+        std::fprintf(stderr, "Could not read %s\n", path.c_str());
+        return 1;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - began).count();
+
+    std::printf("%-32s %-9s %10s %9s %10s %8s %8s\n", "policy", "generator", "runs", "complete", "avg ticks", "deaths",
+                "levels");
+    uint64_t totalRuns = 0;
+    for (const auto& entry : scan.groups) {
+        const ResultsSummary& sum = entry.second;
+        const uint16_t id = entry.first.first;
+        const std::string name = id < names.size() ? names[id] : "#" + std::to_string(id);
+        const char* generator = entry.first.second < LevelGeneratorCount ? generatorName(LevelGenerator(entry.first.second)) : "?";
+        const double runs = double(sum.runs);
+        std::printf("%-32s %-9s %10llu %8.1f%% %10.1f %8.2f %8.2f\n", name.c_str(), generator,
+                    (unsigned long long)sum.runs, 100.0 * double(sum.completed) / runs, double(sum.ticks) / runs,
+                    double(sum.deaths) / runs, double(sum.levels) / runs);
+        totalRuns += sum.runs;
+    }
+    std::printf("%llu runs, %llu blocks read, %llu skipped by the index, %.1f ms\n", (unsigned long long)totalRuns,
+                (unsigned long long)scan.blocksRead, (unsigned long long)scan.blocksSkipped, ms);
+    return 0;
+}
+
+//-----------------------------------------
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return argc == 2 && (!std::strcmp(argv[1], "--help") || !std::strcmp(argv[1], "-h")) ? 0 : 1;
+    }
+    const std::string command = argv[1];
+    const std::string path = argv[2];
+    if (command == "run") return runTournament(path, argc - 3, argv + 3);
+    if (command == "query") return queryTournament(path, argc - 3, argv + 3);
+    printUsage();
+    return 1;
+}